@@ -0,0 +1,374 @@
+/*
+                            meshBenchmark.ino - Hot path micro-benchmarks for meshProtocol.
+                                         Created by Dovydas Bružas, 2026 October 19.
+                                            Released into the public domain.
+
+  Drives meshPacket_isPacketSeen, meshPacket_routeFind, meshPacket_addPendingAck, meshPacket_OnDataRecv and
+  meshPacket_processPackets with synthetic traffic and prints one JSON line per benchmark over Serial:
+
+    {"bench":"routeFind_full_miss","iters":20000,"ns_per_op":812,"heap_delta":0,"table_bytes":390,"limit_ns":2000,"status":"PASS"}
+
+  Last line is {"summary":...} with the number of benchmarks over their limit_ns. Capture it with any serial
+  logger and diff against a previous run. Limits below are for a 240 MHz ESP32, tune them for other targets.
+
+  NOTES:
+  1. Comment out ENABLE_DEBUG_MESSAGES in meshProtocol.h, otherwise Serial.printf() dominates every number.
+  2. Replay mode (meshPacket_setReplayMode()) is on: ACKs and relayed frames are counted in txSuppressed instead of going
+     on air, so process_* numbers don't depend on radio, send callbacks or flow control state.
+  3. Replay mode also skips the 1-5 ms relay delay, so routed (not-for-me) and group relay mixes measure processing only.
+  4. "table_bytes" is NOT measured. It is the static footprint (sizeof) of the tables an operation can walk in the worst
+     case, a hint for cache pressure next to ns_per_op. Cache misses themselves are not counted.
+*/
+
+#include <WiFi.h>
+#include "esp_heap_caps.h"
+#include "meshProtocol.h"
+
+#ifdef ENABLE_DEBUG_MESSAGES
+#warning "meshBenchmark: ENABLE_DEBUG_MESSAGES is defined, process_* numbers will be dominated by Serial output."
+#endif
+
+
+//========================================= DEFINES ==============================================//
+#define BENCH_LOCAL_DEVICE_ID     DEVICE_ID_INTERNET_GATEWAY
+#define BENCH_WIFI_CHANNEL        1
+#define BENCH_LOOKUP_ITERATIONS   20000
+#define BENCH_PROCESS_ROUNDS      200
+
+
+//====================================== VARIABLES =============================================//
+extern uint8_t meshPacket_cacheIndex;
+extern QueueHandle_t meshPacket_Queue;
+extern QueueHandle_t meshPacket_OutboundQueue;
+extern meshPacketCache_t meshPacketCache[MESH_PACKET_CACHE_SIZE];
+extern routingTable_t routingTable[MESH_PACKET_MAX_ROUTES];
+extern PendingAck_t pending[MESH_PACKET_PENDING_ACKS];
+extern meshPacketFlow_t meshPacket_flow[MESH_PACKET_FLOW_HOPS];
+extern groupRoutingTable_t groupRoutingTable[MESH_PACKET_MAX_GROUP_ROUTES];
+extern groupSubscription_t groupSubscriptions[MESH_PACKET_MAX_SUBSCRIPTIONS];
+
+//- Tables meshPacket_processPackets() walks per packet: dedupe, routes, group branches (membership/group check),
+//- pending ACKs (ACK / timeout scan) and flow control (every send).
+#define BENCH_PROCESS_TABLE_BYTES (sizeof(meshPacketCache) + sizeof(routingTable) + sizeof(groupRoutingTable) + sizeof(groupSubscriptions) + sizeof(pending) + sizeof(meshPacket_flow))
+
+struct benchResult_t
+{
+  const char *name;
+  uint32_t iterations;
+  uint32_t cycles;
+  int32_t heapDelta;
+  uint32_t tableBytes;        //- Static footprint (sizeof) of tables the operation can walk. Not measured.
+  uint32_t limit_ns;          //- Regression threshold. 0 = report only.
+};
+
+uint8_t bench_acceptedIDs[] = {BENCH_LOCAL_DEVICE_ID};
+uint16_t bench_uid = 1;
+uint32_t bench_callbackCount = 0;
+uint8_t bench_failed = 0;
+uint8_t bench_total = 0;
+
+volatile uint32_t bench_sink = 0; //- Keeps results of lookups alive.
+
+
+//========================================= FUNCTIONS ==============================================//
+void meshPacket_handlePacketCallback(meshPacket_t *localPacket)
+{
+  bench_callbackCount++;
+}
+
+void bench_resetTables()
+{
+  memset(meshPacketCache, 0, sizeof(meshPacketCache));
+  memset(routingTable, 0, sizeof(routingTable));
+  memset(pending, 0, sizeof(pending));
+  memset(meshPacket_flow, 0, sizeof(meshPacket_flow));
+  memset(groupRoutingTable, 0, sizeof(groupRoutingTable));
+  memset(groupSubscriptions, 0, sizeof(groupSubscriptions));
+  meshPacket_cacheIndex = 0;
+  xQueueReset(meshPacket_Queue);
+  xQueueReset(meshPacket_OutboundQueue);
+  meshPacket_resetStats();
+}
+
+void bench_report(const benchResult_t *result)
+{
+  uint32_t ns_per_op = (uint32_t)(((uint64_t)result->cycles * 1000) / ((uint64_t)getCpuFrequencyMhz() * result->iterations));
+  bool passed = (result->limit_ns == 0) || (ns_per_op <= result->limit_ns);
+
+  bench_total++;
+  if(!passed) bench_failed++;
+
+  Serial.printf("{\"bench\":\"%s\",\"iters\":%lu,\"ns_per_op\":%lu,\"heap_delta\":%ld,\"table_bytes\":%lu,\"limit_ns\":%lu,\"status\":\"%s\"}\n",
+    result->name,
+    (unsigned long)result->iterations,
+    (unsigned long)ns_per_op,
+    (long)result->heapDelta,
+    (unsigned long)result->tableBytes,
+    (unsigned long)result->limit_ns,
+    passed ? "PASS" : "FAIL");
+}
+
+void bench_reportStats(const char *name)
+{
+  meshPacketStats_t stats;
+  meshPacket_getStats(&stats);
+  Serial.printf("{\"stats\":\"%s\",\"rxFrames\":%lu,\"rxQueueDrops\":%lu,\"rxDuplicates\":%lu,\"rxDelivered\":%lu,\"rxRouted\":%lu,\"acksReceived\":%lu,\"txFrames\":%lu,\"txSuppressed\":%lu,\"txErrors\":%lu,\"txDeferred\":%lu,\"txBusy\":%lu}\n",
+    name,
+    (unsigned long)stats.rxFrames, (unsigned long)stats.rxQueueDrops, (unsigned long)stats.rxDuplicates,
+    (unsigned long)stats.rxDelivered, (unsigned long)stats.rxRouted, (unsigned long)stats.acksReceived, (unsigned long)stats.txFrames,
+    (unsigned long)stats.txSuppressed, (unsigned long)stats.txErrors, (unsigned long)stats.txDeferred, (unsigned long)stats.txBusy);
+}
+
+void bench_fillCache()
+{
+  for(uint8_t i = 0; i < MESH_PACKET_CACHE_SIZE; i++)
+  {
+    meshPacket_rememberPacket(i % MAX_IOT_DEVICES, bench_uid++);
+  }
+}
+
+void bench_fillRoutes()
+{
+  uint8_t mac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x00}; //- Locally administered, never on air.
+  for(uint8_t i = 0; i < MESH_PACKET_MAX_ROUTES; i++)
+  {
+    mac[5] = i;
+    meshPacket_routeAdd(i + 1, mac, -50);
+  }
+}
+
+//- Group relay: 16 members of DEVICE_ID_GROUP_TELEMETRY behind 4 distinct next hops, local device isn't subscribed.
+void bench_fillGroupRoutes()
+{
+  uint8_t mac[6] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x00}; //- Locally administered, never on air.
+  for(uint8_t i = 0; i < 16; i++)
+  {
+    mac[5] = i % 4;
+    meshPacket_groupRouteAdd(DEVICE_ID_GROUP_TELEMETRY, 100 + i, mac);
+  }
+}
+
+//- Builds a frame as it would come out of the air and pushes it through meshPacket_OnDataRecv().
+void bench_injectFrame(uint8_t sourceID, uint8_t destinationID, uint8_t packetType, uint16_t uniqueIdentifier, uint8_t payloadLength)
+{
+  static uint8_t srcMAC[6] = {0x02, 0xBE, 0x4C, 0x00, 0x00, 0x00};
+  static uint8_t dstMAC[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+  static wifi_pkt_rx_ctrl_t rxCtrl = {};
+  esp_now_recv_info_t info = {};
+
+  rxCtrl.rssi = -60;
+  srcMAC[5] = sourceID;
+  info.src_addr = srcMAC;
+  info.des_addr = dstMAC;
+  info.rx_ctrl = &rxCtrl;
+
+  meshPacket_t frame = {};
+  frame.sourceID = sourceID;
+  frame.destinationID = destinationID;
+  frame.packetType = packetType;
+  frame.payloadLength = payloadLength;
+  frame.TTL = MESH_PACKET_HOP_LIMIT;
+  frame.uniqueIdentifier = uniqueIdentifier;
+
+  meshPacket_OnDataRecv(&info, (const uint8_t *)&frame, payloadLength + MESH_PACKET_HEADER_LENGTH);
+}
+
+//------------------------------------------ LOOKUPS ------------------------------------------//
+void bench_isPacketSeen()
+{
+  bench_resetTables();
+  bench_fillCache();
+
+  benchResult_t result = {"isPacketSeen_miss", BENCH_LOOKUP_ITERATIONS, 0, 0, sizeof(meshPacketCache), 1500};
+  int32_t heapBefore = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  uint32_t start = ESP.getCycleCount();
+  for(uint32_t i = 0; i < BENCH_LOOKUP_ITERATIONS; i++)
+  {
+    bench_sink += meshPacket_isPacketSeen(MAX_IOT_DEVICES - 1, 0xFFFF); //- Never remembered, full scan.
+  }
+  result.cycles = ESP.getCycleCount() - start;
+  result.heapDelta = heapBefore - (int32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  bench_report(&result);
+
+  result = {"isPacketSeen_hit", BENCH_LOOKUP_ITERATIONS, 0, 0, sizeof(meshPacketCache), 1500};
+  heapBefore = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  start = ESP.getCycleCount();
+  for(uint32_t i = 0; i < BENCH_LOOKUP_ITERATIONS; i++)
+  {
+    uint8_t slot = i % MESH_PACKET_CACHE_SIZE;
+    bench_sink += meshPacket_isPacketSeen(meshPacketCache[slot].sourceID, meshPacketCache[slot].uniqueIdentifier);
+  }
+  result.cycles = ESP.getCycleCount() - start;
+  result.heapDelta = heapBefore - (int32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  bench_report(&result);
+}
+
+void bench_routeFind()
+{
+  bench_resetTables();
+  bench_fillRoutes();
+
+  benchResult_t result = {"routeFind_full_miss", BENCH_LOOKUP_ITERATIONS, 0, 0, sizeof(routingTable), 2000};
+  int32_t heapBefore = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  uint32_t start = ESP.getCycleCount();
+  for(uint32_t i = 0; i < BENCH_LOOKUP_ITERATIONS; i++)
+  {
+    bench_sink += meshPacket_routeFind(DEVICE_ID_DATABASE); //- Not in table, full scan.
+  }
+  result.cycles = ESP.getCycleCount() - start;
+  result.heapDelta = heapBefore - (int32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  bench_report(&result);
+
+  result = {"routeFind_full_hit", BENCH_LOOKUP_ITERATIONS, 0, 0, sizeof(routingTable), 2000};
+  heapBefore = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  start = ESP.getCycleCount();
+  for(uint32_t i = 0; i < BENCH_LOOKUP_ITERATIONS; i++)
+  {
+    bench_sink += meshPacket_routeFind((i % MESH_PACKET_MAX_ROUTES) + 1);
+  }
+  result.cycles = ESP.getCycleCount() - start;
+  result.heapDelta = heapBefore - (int32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  bench_report(&result);
+}
+
+void bench_addPendingAck()
+{
+  bench_resetTables();
+
+  meshPacket_t packet = {};
+  packet.payloadLength = MAXIMUM_PACKET_LENGTH - MESH_PACKET_HEADER_LENGTH;
+
+  //- ACK storm: table is always full, every add evicts the oldest slot, every second one is acknowledged.
+  benchResult_t result = {"addPendingAck_storm", BENCH_LOOKUP_ITERATIONS, 0, 0, sizeof(pending), 8000};
+  int32_t heapBefore = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  uint32_t start = ESP.getCycleCount();
+  for(uint32_t i = 0; i < BENCH_LOOKUP_ITERATIONS; i++)
+  {
+    uint16_t uid = bench_uid++;
+    if(uid == 0) uid = bench_uid++; //- 0 marks a free slot.
+    meshPacket_addPendingAck(uid, DEVICE_ID_DATABASE, &packet);
+    if(i & 1) meshPacket_markDelivered(uid - 1, DEVICE_ID_DATABASE);
+  }
+  result.cycles = ESP.getCycleCount() - start;
+  result.heapDelta = heapBefore - (int32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  bench_report(&result);
+}
+
+//------------------------------------------ RECEIVE PATH ------------------------------------------//
+void bench_onDataRecv()
+{
+  bench_resetTables();
+
+  benchResult_t result = {"onDataRecv_copy_250B", 0, 0, 0, sizeof(meshPacketQueue_t), 20000};
+  int32_t heapBefore = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  for(uint32_t round = 0; round < BENCH_PROCESS_ROUNDS; round++)
+  {
+    uint32_t start = ESP.getCycleCount();
+    for(uint8_t i = 0; i < MESH_PACKET_QUEUE_LENGTH; i++)
+    {
+      bench_injectFrame(1, BENCH_LOCAL_DEVICE_ID, PACKET_TYPE_TELEMETRY, bench_uid++, MAXIMUM_PACKET_LENGTH - MESH_PACKET_HEADER_LENGTH);
+    }
+    result.cycles += ESP.getCycleCount() - start;
+    result.iterations += MESH_PACKET_QUEUE_LENGTH;
+    xQueueReset(meshPacket_Queue); //- Not timed.
+  }
+  result.heapDelta = heapBefore - (int32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  bench_report(&result);
+  bench_reportStats(result.name);
+}
+
+//- Fills the queue with one traffic mix and times meshPacket_processPackets() draining it.
+typedef void (*benchMix_t)(uint8_t index);
+typedef void (*benchSetup_t)();
+
+void bench_process(const char *name, benchMix_t mix, benchSetup_t setupTables, uint32_t limit_ns)
+{
+  bench_resetTables();
+  if(setupTables != NULL) setupTables();
+
+  benchResult_t result = {name, 0, 0, 0, BENCH_PROCESS_TABLE_BYTES, limit_ns};
+  int32_t heapBefore = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  for(uint32_t round = 0; round < BENCH_PROCESS_ROUNDS; round++)
+  {
+    for(uint8_t i = 0; i < MESH_PACKET_QUEUE_LENGTH; i++) mix(i); //- Not timed.
+
+    uint32_t start = ESP.getCycleCount();
+    meshPacket_processPackets(bench_acceptedIDs, sizeof(bench_acceptedIDs), 0);
+    result.cycles += ESP.getCycleCount() - start;
+    result.iterations += MESH_PACKET_QUEUE_LENGTH;
+  }
+  result.heapDelta = heapBefore - (int32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  bench_report(&result);
+  bench_reportStats(name);
+}
+
+void bench_mixUnique(uint8_t index)
+{
+  bench_injectFrame((index % 8) + 1, BENCH_LOCAL_DEVICE_ID, PACKET_TYPE_TELEMETRY, bench_uid++, 32);
+}
+
+void bench_mixUniqueManySources(uint8_t index)
+{
+  uint16_t uid = bench_uid++;
+  bench_injectFrame(MESH_PACKET_MAX_ROUTES + 1 + (uid % 64), BENCH_LOCAL_DEVICE_ID, PACKET_TYPE_TELEMETRY, uid, 32); //- Sources not in a full table.
+}
+
+void bench_mixDuplicateFlood(uint8_t index)
+{
+  if(index == 0) bench_uid++;
+  bench_injectFrame(1, BENCH_LOCAL_DEVICE_ID, PACKET_TYPE_TELEMETRY, bench_uid, 32); //- 1 unique, rest are duplicates.
+}
+
+void bench_mixAckStorm(uint8_t index)
+{
+  meshPacket_t packet = {};
+  uint16_t uid = bench_uid++;
+  if(uid == 0) uid = bench_uid++;
+  meshPacket_addPendingAck(uid, DEVICE_ID_DATABASE, &packet);
+  bench_injectFrame(DEVICE_ID_DATABASE, BENCH_LOCAL_DEVICE_ID, PACKET_TYPE_ACKNOWLEDGEMENT, uid, 0);
+}
+
+void bench_mixRouted(uint8_t index)
+{
+  bench_injectFrame((index % 8) + 1, (index % 8) + 9, PACKET_TYPE_TELEMETRY, bench_uid++, 32); //- Known route, not for me.
+}
+
+void bench_mixGroupRelay(uint8_t index)
+{
+  bench_injectFrame((index % 8) + 1, DEVICE_ID_GROUP_TELEMETRY, PACKET_TYPE_TELEMETRY, bench_uid++, 32); //- 4 copies per frame.
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+
+  WiFi.mode(WIFI_STA);
+  if(meshPacket_init(BENCH_WIFI_CHANNEL) != ESP_OK)
+  {
+    Serial.println("{\"error\":\"meshPacket_init failed\"}");
+    return;
+  }
+  meshPacket_setReplayMode(true); //- Nothing goes on air, see NOTE 2.
+
+  Serial.printf("{\"target\":\"%s\",\"cpu_mhz\":%lu,\"cache\":%u,\"routes\":%u,\"pending\":%u,\"queue\":%u}\n",
+    ESP.getChipModel(), (unsigned long)getCpuFrequencyMhz(), MESH_PACKET_CACHE_SIZE, MESH_PACKET_MAX_ROUTES, MESH_PACKET_PENDING_ACKS, MESH_PACKET_QUEUE_LENGTH);
+
+  bench_isPacketSeen();
+  bench_routeFind();
+  bench_addPendingAck();
+  bench_onDataRecv();
+  bench_process("process_unique", bench_mixUnique, NULL, 60000);
+  bench_process("process_unique_full_routes", bench_mixUniqueManySources, bench_fillRoutes, 80000);
+  bench_process("process_duplicate_flood", bench_mixDuplicateFlood, NULL, 20000);
+  bench_process("process_ack_storm", bench_mixAckStorm, NULL, 30000);
+  bench_process("process_routed", bench_mixRouted, bench_fillRoutes, 60000);
+  bench_process("process_group_relay", bench_mixGroupRelay, bench_fillGroupRoutes, 80000);
+
+  Serial.printf("{\"summary\":\"%s\",\"benchmarks\":%u,\"failed\":%u}\n", bench_failed ? "FAIL" : "PASS", bench_total, bench_failed);
+}
+
+void loop()
+{
+  delay(1000);
+}
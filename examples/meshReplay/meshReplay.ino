@@ -0,0 +1,212 @@
+/*
+                            meshReplay.ino - Replays captured mesh traffic through meshPacket_processPackets.
+                                         Created by Dovydas Bružas, 2026 October 19.
+                                            Released into the public domain.
+
+  Counterpart of extras/replay/meshReplay.py. Host streams frames of a pcap capture (MESH_PACKET_ENABLE_CAPTURE)
+  over Serial, sketch stores them in RAM and feeds them into meshPacket_OnDataRecv() -> meshPacket_processPackets()
+  at original or maximum speed. Timing doesn't depend on Serial speed. After each run one JSON line is printed:
+
+    {"result":"replay","mode":"max","frames":128,"wall_us":5210,"ns_per_packet":40703,"packets_per_s":24568,"delivered":12,...}
+
+  Serial protocol (host -> device):
+    'F' <uint16 length> <uint32 seconds> <uint32 microseconds> <pseudo-header + frame>   Store frame (pcap record).
+    'R' <uint8 mode>                                                                      Run. 0 = original speed, 1 = maximum speed.
+    'C'                                                                                   Clear stored frames.
+
+  NOTES:
+  1. Set REPLAY_ACCEPTED_IDS to what the node under investigation passes to meshPacket_processPackets().
+  2. Replay mode (meshPacket_setReplayMode()) is on: ACKs and relayed frames are counted in txSuppressed, nothing goes on air
+     and the 1-5 ms relay delay is skipped. Relay captures measure processing, not sleep.
+  3. Comment out ENABLE_DEBUG_MESSAGES for throughput numbers, keep it to see how each frame was handled.
+*/
+
+#include <WiFi.h>
+#include "esp_timer.h"
+#include "meshProtocol.h"
+
+
+//========================================= DEFINES ==============================================//
+#define REPLAY_ACCEPTED_IDS       {DEVICE_ID_INTERNET_GATEWAY, DEVICE_ID_DATABASE}
+#define REPLAY_WIFI_CHANNEL       1
+#define REPLAY_SERIAL_BAUD        921600
+#define REPLAY_MAX_FRAMES         128     //- Frames stored per run. Host sends longer captures in batches.
+
+#define REPLAY_MODE_ORIGINAL      0
+#define REPLAY_MODE_MAX           1
+
+
+//====================================== STRUCTURE VARIABLES =============================================//
+struct __attribute__((packed)) replayFrame_t
+{
+  uint64_t timestamp_us;
+  uint8_t length;
+  int8_t RSSI;
+  uint8_t MAC[6];
+  uint8_t data[sizeof(meshPacket_t)];
+};
+
+
+//====================================== VARIABLES =============================================//
+extern QueueHandle_t meshPacket_Queue;
+
+uint8_t replay_acceptedIDs[] = REPLAY_ACCEPTED_IDS;
+replayFrame_t replay_frames[REPLAY_MAX_FRAMES];
+uint16_t replay_frameCount = 0;
+uint32_t replay_skipped = 0;      //- TX frames, oversized frames or frames over REPLAY_MAX_FRAMES.
+
+
+//========================================= FUNCTIONS ==============================================//
+bool replay_readExact(uint8_t *buffer, size_t length)
+{
+  return Serial.readBytes(buffer, length) == length;
+}
+
+void replay_storeFrame()
+{
+  uint8_t header[10]; //- uint16 length, uint32 seconds, uint32 microseconds.
+  if(!replay_readExact(header, sizeof(header))) return;
+
+  uint16_t length = header[0] | (header[1] << 8);
+  uint32_t seconds = header[2] | (header[3] << 8) | (header[4] << 16) | ((uint32_t)header[5] << 24);
+  uint32_t microseconds = header[6] | (header[7] << 8) | (header[8] << 16) | ((uint32_t)header[9] << 24);
+
+  uint8_t record[MESH_PACKET_CAPTURE_HEADER_LENGTH + sizeof(meshPacket_t)];
+  if(length > sizeof(record) || length < MESH_PACKET_CAPTURE_HEADER_LENGTH + MESH_PACKET_HEADER_LENGTH)
+  {
+    uint8_t discard;
+    while(length-- > 0 && replay_readExact(&discard, 1)) { } //- Skip it, next byte is a command again.
+    replay_skipped++;
+    return;
+  }
+  if(!replay_readExact(record, length)) return;
+
+  //- record[0] direction, record[1] RSSI, record[2..7] MAC. Only received frames are replayed.
+  if(record[0] != MESH_PACKET_CAPTURE_RX || replay_frameCount >= REPLAY_MAX_FRAMES)
+  {
+    replay_skipped++;
+    return;
+  }
+
+  replayFrame_t *frame = &replay_frames[replay_frameCount++];
+  frame->timestamp_us = (uint64_t)seconds * 1000000 + microseconds;
+  frame->length = length - MESH_PACKET_CAPTURE_HEADER_LENGTH;
+  frame->RSSI = (int8_t)record[1];
+  memcpy(frame->MAC, &record[2], 6);
+  memcpy(frame->data, &record[MESH_PACKET_CAPTURE_HEADER_LENGTH], frame->length);
+}
+
+void replay_injectFrame(replayFrame_t *frame)
+{
+  static uint8_t dstMAC[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+  wifi_pkt_rx_ctrl_t rxCtrl = {};
+  esp_now_recv_info_t info = {};
+
+  rxCtrl.rssi = frame->RSSI;
+  info.src_addr = frame->MAC;
+  info.des_addr = dstMAC;
+  info.rx_ctrl = &rxCtrl;
+
+  meshPacket_OnDataRecv(&info, frame->data, frame->length);
+}
+
+void replay_run(uint8_t mode)
+{
+  meshPacket_resetStats();
+
+  uint32_t cycles = 0;
+  int64_t start_us = esp_timer_get_time();
+  for(uint16_t i = 0; i < replay_frameCount; i++)
+  {
+    if(mode == REPLAY_MODE_ORIGINAL) //- Keep inter-frame gaps of the capture.
+    {
+      int64_t due_us = start_us + (int64_t)(replay_frames[i].timestamp_us - replay_frames[0].timestamp_us);
+      int64_t wait_us = due_us - esp_timer_get_time();
+      if(wait_us > 2000) vTaskDelay(pdMS_TO_TICKS(wait_us / 1000));
+      while(esp_timer_get_time() < due_us) { }
+    }
+
+    replay_injectFrame(&replay_frames[i]);
+
+    //- At maximum speed queue is filled up first, as it would be in a burst.
+    if(mode == REPLAY_MODE_ORIGINAL || uxQueueSpacesAvailable(meshPacket_Queue) == 0 || i == replay_frameCount - 1)
+    {
+      uint32_t cyclesStart = ESP.getCycleCount();
+      meshPacket_processPackets(replay_acceptedIDs, sizeof(replay_acceptedIDs), 0);
+      cycles += ESP.getCycleCount() - cyclesStart;
+    }
+  }
+  int64_t wall_us = esp_timer_get_time() - start_us;
+
+  uint64_t processing_ns = ((uint64_t)cycles * 1000) / getCpuFrequencyMhz();
+  uint32_t ns_per_packet = replay_frameCount ? (uint32_t)(processing_ns / replay_frameCount) : 0;
+  uint32_t packets_per_s = processing_ns ? (uint32_t)(((uint64_t)replay_frameCount * 1000000000ULL) / processing_ns) : 0;
+
+  meshPacketStats_t stats;
+  meshPacket_getStats(&stats);
+  Serial.printf("{\"result\":\"replay\",\"mode\":\"%s\",\"frames\":%u,\"skipped\":%lu,\"wall_us\":%lld,\"ns_per_packet\":%lu,\"packets_per_s\":%lu,"
+                "\"queueDrops\":%lu,\"duplicates\":%lu,\"delivered\":%lu,\"routed\":%lu,\"acksReceived\":%lu,\"txFrames\":%lu,\"txSuppressed\":%lu,\"txBusy\":%lu}\n",
+    (mode == REPLAY_MODE_ORIGINAL) ? "original" : "max",
+    replay_frameCount, (unsigned long)replay_skipped, (long long)wall_us, (unsigned long)ns_per_packet, (unsigned long)packets_per_s,
+    (unsigned long)stats.rxQueueDrops, (unsigned long)stats.rxDuplicates, (unsigned long)stats.rxDelivered, (unsigned long)stats.rxRouted,
+    (unsigned long)stats.acksReceived, (unsigned long)stats.txFrames, (unsigned long)stats.txSuppressed, (unsigned long)stats.txBusy);
+
+  replay_frameCount = 0;
+  replay_skipped = 0;
+}
+
+void meshPacket_handlePacketCallback(meshPacket_t *localPacket)
+{
+  //- Delivered frames are counted by library (rxDelivered). Add application handling here to reproduce it as well.
+}
+
+void setup()
+{
+  Serial.begin(REPLAY_SERIAL_BAUD);
+  Serial.setTimeout(1000);
+
+  WiFi.mode(WIFI_STA);
+  if(meshPacket_init(REPLAY_WIFI_CHANNEL) != ESP_OK)
+  {
+    Serial.println("{\"error\":\"meshPacket_init failed\"}");
+    return;
+  }
+  meshPacket_setReplayMode(true); //- Keep replayed ACKs and relayed frames off air.
+  Serial.printf("{\"ready\":\"replay\",\"max_frames\":%u}\n", REPLAY_MAX_FRAMES);
+}
+
+void loop()
+{
+  if(Serial.available() <= 0)
+  {
+    delay(1);
+    return;
+  }
+
+  switch(Serial.read())
+  {
+    case 'F':
+    {
+      replay_storeFrame();
+      break;
+    }
+    case 'R':
+    {
+      uint8_t mode = REPLAY_MODE_MAX;
+      replay_readExact(&mode, 1);
+      replay_run(mode);
+      break;
+    }
+    case 'C':
+    {
+      replay_frameCount = 0;
+      replay_skipped = 0;
+      Serial.printf("{\"ready\":\"replay\",\"max_frames\":%u}\n", REPLAY_MAX_FRAMES);
+      break;
+    }
+    default:
+    {
+      break; //- Not a command byte, resync.
+    }
+  }
+}
@@ -0,0 +1,261 @@
+#!/usr/bin/env python3
+"""
+meshReplay.py - Capture and replay meshProtocol traffic.
+
+  capture:  Reads records written by meshPacket_captureStream() from a serial port (or any file) and stores them as
+            .pcap. Tool writes its own pcap header and syncs on record boundaries, so it can attach to a device that
+            is already running. Other output on the port is skipped, but a port without it is more reliable.
+  replay:   Sends RX frames of a .pcap to examples/meshReplay sketch, which feeds them into meshPacket_processPackets()
+            at original or maximum speed and reports processing throughput.
+            Nothing is sent on air during replay, relayed frames and ACKs are counted in txSuppressed.
+  dump:     Prints frames of a .pcap, no device needed.
+
+Examples:
+  python3 meshReplay.py capture --port /dev/ttyUSB1 --baud 921600 -o relay.pcap
+  python3 meshReplay.py replay relay.pcap --port /dev/ttyUSB0 --speed max
+  python3 meshReplay.py dump relay.pcap
+
+Requires pyserial for capture/replay (pip install pyserial).
+"""
+
+import argparse
+import json
+import struct
+import sys
+import time
+
+LINKTYPE_MESH = 147           # MESH_PACKET_CAPTURE_LINKTYPE (LINKTYPE_USER0).
+CAPTURE_HEADER_LENGTH = 8     # MESH_PACKET_CAPTURE_HEADER_LENGTH: direction, RSSI, MAC[6].
+MESH_HEADER_LENGTH = 11       # MESH_PACKET_HEADER_LENGTH.
+MAXIMUM_PACKET_LENGTH = 250   # sizeof(meshPacket_t).
+SNAP_LENGTH = CAPTURE_HEADER_LENGTH + MAXIMUM_PACKET_LENGTH
+RECORD_HEADER_LENGTH = 16
+PCAP_MAGIC = struct.pack("<I", 0xA1B2C3D4)    # ESP32 is little endian, so is the stream.
+PCAP_HEADER_LENGTH = 24
+DIRECTION_RX = 0
+DIRECTION_TX = 1
+
+
+def read_pcap(path):
+    """Yields (timestamp_us, record bytes) of every frame in a meshProtocol pcap."""
+    with open(path, "rb") as f:
+        header = f.read(24)
+        if len(header) < 24:
+            raise ValueError("%s: not a pcap file" % path)
+
+        magic = struct.unpack("<I", header[:4])[0]
+        if magic in (0xA1B2C3D4, 0xA1B23C4D):
+            endian = "<"
+        elif magic in (0xD4C3B2A1, 0x4D3CB2A1):
+            endian = ">"
+        else:
+            raise ValueError("%s: not a pcap file" % path)
+        nanoseconds = magic in (0xA1B23C4D, 0x4D3CB2A1)
+
+        linktype = struct.unpack(endian + "I", header[20:24])[0] & 0xFFFF
+        if linktype != LINKTYPE_MESH:
+            raise ValueError("%s: link type %d, expected %d" % (path, linktype, LINKTYPE_MESH))
+
+        while True:
+            record_header = f.read(16)
+            if len(record_header) < 16:
+                return
+            seconds, fraction, captured, _ = struct.unpack(endian + "IIII", record_header)
+            record = f.read(captured)
+            if len(record) < captured:
+                return
+            yield seconds * 1000000 + (fraction // 1000 if nanoseconds else fraction), record
+
+
+def open_serial(port, baud):
+    try:
+        import serial
+    except ImportError:
+        sys.exit("pyserial is required: pip install pyserial")
+    return serial.Serial(port, baud, timeout=1)
+
+
+def record_at(buffer, offset, strict):
+    """Length of a plausible capture record at 'offset', 0 if there is none, None if more bytes are needed.
+
+    Stream has no markers, so a record is recognised by its header: microseconds below 1 s, captured == original
+    length within limits and a known direction. While syncing ('strict') payloadLength must match the length too.
+    """
+    if len(buffer) < offset + RECORD_HEADER_LENGTH + CAPTURE_HEADER_LENGTH + MESH_HEADER_LENGTH:
+        return None
+    _, microseconds, captured, original = struct.unpack_from("<IIII", buffer, offset)
+    if microseconds >= 1000000 or captured != original:
+        return 0
+    if captured < CAPTURE_HEADER_LENGTH + MESH_HEADER_LENGTH or captured > SNAP_LENGTH:
+        return 0
+    record = offset + RECORD_HEADER_LENGTH
+    if buffer[record] not in (DIRECTION_RX, DIRECTION_TX):
+        return 0
+    if strict and captured != CAPTURE_HEADER_LENGTH + MESH_HEADER_LENGTH + buffer[record + CAPTURE_HEADER_LENGTH + 3]:
+        return 0
+    return RECORD_HEADER_LENGTH + captured
+
+
+def timestamp_at(buffer, offset):
+    seconds, microseconds = struct.unpack_from("<II", buffer, offset)
+    return seconds * 1000000 + microseconds
+
+
+def wait_json(port, key, timeout_s):
+    """Reads lines until a JSON object with 'key' shows up. Debug output in between is echoed to stderr."""
+    deadline = time.monotonic() + timeout_s
+    while time.monotonic() < deadline:
+        line = port.readline().decode("utf-8", "replace").strip()
+        if not line:
+            continue
+        if line.startswith("{"):
+            try:
+                message = json.loads(line)
+            except ValueError:
+                message = None
+            if message is not None and key in message:
+                return message
+        print(line, file=sys.stderr)
+    return None
+
+
+def command_capture(args):
+    source = open_serial(args.port, args.baud) if args.port else open(args.input, "rb")
+    frames = 0
+    resyncs = 0
+    synced = False
+    buffer = bytearray()
+    with open(args.output, "wb") as out:
+        # Own global header: device writes one only at boot (meshPacket_captureWriteHeader()), host may attach later.
+        out.write(struct.pack("<IHHiIII", 0xA1B2C3D4, 2, 4, 0, 0, SNAP_LENGTH, LINKTYPE_MESH))
+
+        started = time.monotonic()
+        try:
+            while args.duration == 0 or time.monotonic() - started < args.duration:
+                chunk = source.read((source.in_waiting or 1) if args.port else 4096)
+                if not chunk:
+                    if not args.port:
+                        break
+                    continue
+                buffer += chunk
+
+                while True:
+                    # Device rebooted (or was attached at boot): its global header is not a record.
+                    if buffer[:4] == PCAP_MAGIC:
+                        if len(buffer) < PCAP_HEADER_LENGTH:
+                            break
+                        del buffer[:PCAP_HEADER_LENGTH]
+                        synced = False
+                        continue
+
+                    length = record_at(buffer, 0, not synced)
+                    if length and not synced:
+                        # Two records in a row, in time order and less than a minute apart, before trusting it.
+                        following = record_at(buffer, length, True)
+                        if following:
+                            gap = timestamp_at(buffer, length) - timestamp_at(buffer, 0)
+                            following = following if 0 <= gap < 60000000 else 0
+                        length = None if following is None else (length if following else 0)
+                    if length is None or (length and len(buffer) < length):
+                        break
+                    if length == 0:
+                        if synced:
+                            resyncs += 1
+                            print("lost sync after %d frames, resyncing" % frames, file=sys.stderr)
+                        synced = False
+                        del buffer[0]
+                        continue
+
+                    synced = True
+                    out.write(buffer[:length])
+                    del buffer[:length]
+                    frames += 1
+                out.flush()
+        except KeyboardInterrupt:
+            pass
+    print("captured %d frames to %s (%d resyncs)" % (frames, args.output, resyncs), file=sys.stderr)
+
+
+def command_replay(args):
+    frames = [(ts, record) for ts, record in read_pcap(args.capture) if record[0] == DIRECTION_RX]
+    if not frames:
+        sys.exit("%s: no RX frames" % args.capture)
+
+    port = open_serial(args.port, args.baud)
+    port.write(b"C")
+    ready = wait_json(port, "ready", 5)
+    if ready is None:
+        sys.exit("device didn't answer, is examples/meshReplay flashed?")
+
+    batch = ready.get("max_frames", 128)
+    mode = 1 if args.speed == "max" else 0
+    results = []
+    for start in range(0, len(frames), batch):
+        for timestamp_us, record in frames[start:start + batch]:
+            port.write(b"F" + struct.pack("<HII", len(record), timestamp_us // 1000000, timestamp_us % 1000000) + record)
+        port.write(b"R" + bytes([mode]))
+        result = wait_json(port, "result", 60)
+        if result is None:
+            sys.exit("device didn't report result")
+        print(json.dumps(result))
+        results.append(result)
+
+    frames_total = sum(r["frames"] for r in results)
+    processing_ns = sum(r["ns_per_packet"] * r["frames"] for r in results)
+    summary = {
+        "summary": "replay",
+        "mode": args.speed,
+        "frames": frames_total,
+        "ns_per_packet": processing_ns // frames_total if frames_total else 0,
+        "packets_per_s": int(frames_total * 1e9 / processing_ns) if processing_ns else 0,
+    }
+    for key in ("queueDrops", "duplicates", "delivered", "routed", "acksReceived", "txFrames", "txSuppressed", "txBusy"):
+        summary[key] = sum(r.get(key, 0) for r in results)
+    print(json.dumps(summary))
+
+
+def command_dump(args):
+    first = None
+    for timestamp_us, record in read_pcap(args.capture):
+        first = timestamp_us if first is None else first
+        direction, rssi = record[0], struct.unpack("b", record[1:2])[0]
+        mac = ":".join("%02X" % b for b in record[2:8])
+        frame = record[CAPTURE_HEADER_LENGTH:]
+        if len(frame) < MESH_HEADER_LENGTH:
+            print("%12.6f short frame" % ((timestamp_us - first) / 1e6))
+            continue
+        source, destination, packet_type, length, ttl, uid = struct.unpack("<BBBBBH", frame[:7])
+        print("%12.6f %s %s RSSI %4d  S%02d D%03d T%03d L%03d TTL%d UID%05d" % (
+            (timestamp_us - first) / 1e6, "RX" if direction == DIRECTION_RX else "TX", mac, rssi,
+            source, destination, packet_type, length, ttl, uid))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Capture and replay meshProtocol traffic.")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    capture = commands.add_parser("capture", help="store pcap stream from a device")
+    capture.add_argument("--port", help="serial port streaming meshPacket_captureStream()")
+    capture.add_argument("--input", help="read stream from file instead of serial port")
+    capture.add_argument("--baud", type=int, default=921600)
+    capture.add_argument("--duration", type=float, default=0, help="seconds, 0 = until Ctrl+C")
+    capture.add_argument("-o", "--output", required=True)
+
+    replay = commands.add_parser("replay", help="replay capture on examples/meshReplay")
+    replay.add_argument("capture")
+    replay.add_argument("--port", required=True)
+    replay.add_argument("--baud", type=int, default=921600)
+    replay.add_argument("--speed", choices=("original", "max"), default="original")
+
+    dump = commands.add_parser("dump", help="print frames of a capture")
+    dump.add_argument("capture")
+
+    args = parser.parse_args()
+    if args.command == "capture" and not (args.port or args.input):
+        parser.error("capture needs --port or --input")
+
+    {"capture": command_capture, "replay": command_replay, "dump": command_dump}[args.command](args)
+
+
+if __name__ == "__main__":
+    main()
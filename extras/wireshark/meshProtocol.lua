@@ -0,0 +1,106 @@
+--[[
+    meshProtocol.lua - Wireshark dissector for meshProtocol captures (MESH_PACKET_ENABLE_CAPTURE).
+
+    Install: copy to Wireshark personal Lua plugins folder (Help -> About -> Folders) and restart.
+    Frames are stored with link type 147 (LINKTYPE_USER0). Each record is:
+
+      Offset  Size  Field
+      0       1     direction           0 = RX, 1 = TX
+      1       1     RSSI                int8, dBm (0 for TX)
+      2       6     MAC                 source MAC (RX) / next hop MAC (TX)
+      8       1     sourceID            meshPacket_t starts here
+      9       1     destinationID       200-239 = group, 250 = database, 254 = broadcast
+      10      1     packetType
+      11      1     payloadLength
+      12      1     TTL
+      13      2     uniqueIdentifier    little endian
+      15      4     reserved            little endian
+      19      N     payload             N = payloadLength
+]]
+
+local mesh = Proto("meshprotocol", "ESP-NOW Mesh Protocol")
+
+local directions = { [0] = "RX", [1] = "TX" }
+
+local packetTypes = {
+    [0]   = "TELEMETRY",
+    [1]   = "CONTROL",
+    [2]   = "NOTIFICATION",
+    [100] = "ACKNOWLEDGEMENT",
+    [101] = "BEACON",
+    [102] = "GROUP_JOIN",
+    [103] = "GROUP_LEAVE",
+}
+
+local deviceIDs = {
+    [250] = "DATABASE",
+    [254] = "BROADCAST",
+    [255] = "UNCONFIGURED",
+}
+
+local f = mesh.fields
+f.direction        = ProtoField.uint8("meshprotocol.direction", "Direction", base.DEC, directions)
+f.rssi             = ProtoField.int8("meshprotocol.rssi", "RSSI (dBm)", base.DEC)
+f.mac              = ProtoField.ether("meshprotocol.mac", "MAC")
+f.sourceID         = ProtoField.uint8("meshprotocol.src", "Source ID", base.DEC, deviceIDs)
+f.destinationID    = ProtoField.uint8("meshprotocol.dst", "Destination ID", base.DEC, deviceIDs)
+f.group            = ProtoField.bool("meshprotocol.group", "Group destination")
+f.packetType       = ProtoField.uint8("meshprotocol.type", "Packet type", base.DEC, packetTypes)
+f.payloadLength    = ProtoField.uint8("meshprotocol.len", "Payload length", base.DEC)
+f.TTL              = ProtoField.uint8("meshprotocol.ttl", "TTL", base.DEC)
+f.uniqueIdentifier = ProtoField.uint16("meshprotocol.uid", "Unique identifier", base.DEC)
+f.reserved         = ProtoField.uint32("meshprotocol.reserved", "Reserved", base.HEX)
+f.joinGroup        = ProtoField.uint8("meshprotocol.join_group", "Group ID", base.DEC)
+f.payload          = ProtoField.bytes("meshprotocol.payload", "Payload")
+
+local CAPTURE_HEADER_LENGTH = 8
+local MESH_HEADER_LENGTH = 11
+
+function mesh.dissector(buffer, pinfo, tree)
+    if buffer:len() < CAPTURE_HEADER_LENGTH + MESH_HEADER_LENGTH then return 0 end
+
+    pinfo.cols.protocol = "MESH"
+    local root = tree:add(mesh, buffer(), "ESP-NOW Mesh Protocol")
+
+    root:add(f.direction, buffer(0, 1))
+    root:add(f.rssi, buffer(1, 1))
+    root:add(f.mac, buffer(2, 6))
+
+    local frame = buffer(CAPTURE_HEADER_LENGTH)
+    local sourceID = frame(0, 1):uint()
+    local destinationID = frame(1, 1):uint()
+    local packetType = frame(2, 1):uint()
+    local payloadLength = frame(3, 1):uint()
+    local isGroup = destinationID >= 200 and destinationID <= 239
+
+    local header = root:add(mesh, frame(0, MESH_HEADER_LENGTH), "Header")
+    header:add(f.sourceID, frame(0, 1))
+    header:add(f.destinationID, frame(1, 1))
+    header:add(f.group, frame(1, 1), isGroup)
+    header:add(f.packetType, frame(2, 1))
+    header:add(f.payloadLength, frame(3, 1))
+    header:add(f.TTL, frame(4, 1))
+    header:add_le(f.uniqueIdentifier, frame(5, 2))
+    header:add_le(f.reserved, frame(7, 4))
+
+    local available = frame:len() - MESH_HEADER_LENGTH
+    if payloadLength > 0 and available > 0 then
+        local payload = frame(MESH_HEADER_LENGTH, math.min(payloadLength, available))
+        if (packetType == 102 or packetType == 103) and payloadLength >= 1 then
+            root:add(f.joinGroup, payload(0, 1))
+        else
+            root:add(f.payload, payload)
+        end
+    end
+
+    pinfo.cols.src = string.format("S%02d", sourceID)
+    pinfo.cols.dst = isGroup and string.format("G%03d", destinationID) or string.format("D%02d", destinationID)
+    pinfo.cols.info = string.format("%s %s UID%05d TTL%d L%d RSSI %d",
+        directions[buffer(0, 1):uint()] or "?",
+        packetTypes[packetType] or string.format("T%02d", packetType),
+        frame(5, 2):le_uint(), frame(4, 1):uint(), payloadLength, buffer(1, 1):int())
+
+    return buffer:len()
+end
+
+DissectorTable.get("wtap_encap"):add(wtap.USER0, mesh)
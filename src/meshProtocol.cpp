@@ -10,6 +10,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/portmacro.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 
 #include "meshProtocol.h"
 
@@ -20,6 +21,7 @@ uint16_t meshPacket_messageCounter = 0;
 uint32_t meshPacket_deviceLastSeen[MAX_IOT_DEVICES];
 
 QueueHandle_t meshPacket_Queue;
+QueueHandle_t meshPacket_OutboundQueue;
 
 uint8_t meshPacket_broadcastAddress[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
 
@@ -27,7 +29,30 @@ uint8_t meshPacket_broadcastAddress[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
 meshPacketCache_t meshPacketCache[MESH_PACKET_CACHE_SIZE];
 knownPeers_t knownPeers[MAX_PEERS];
 routingTable_t routingTable[MESH_PACKET_MAX_ROUTES];
+groupRoutingTable_t groupRoutingTable[MESH_PACKET_MAX_GROUP_ROUTES];
+groupSubscription_t groupSubscriptions[MESH_PACKET_MAX_SUBSCRIPTIONS];
+uint32_t meshPacket_lastGroupAdvertise = 0;
 PendingAck_t pending[MESH_PACKET_PENDING_ACKS];
+meshPacketFlow_t meshPacket_flow[MESH_PACKET_FLOW_HOPS];
+
+portMUX_TYPE meshPacket_flowLock = portMUX_INITIALIZER_UNLOCKED; //- meshPacket_flow is shared with WiFi task (send callback).
+
+#ifdef MESH_PACKET_ENABLE_CAPTURE
+struct meshPacketCaptureSlot_t
+{
+  uint32_t sequence;            //- Ticket + 1 once the record is complete. Consumer waits for it.
+  meshPacketCapture_t record;
+};
+
+meshPacketCaptureSlot_t meshPacket_captureRing[MESH_PACKET_CAPTURE_SLOTS];
+uint32_t meshPacket_captureHead = 0; //- Next ticket for producers (WiFi task, sending task(s)).
+uint32_t meshPacket_captureTail = 0; //- Next ticket for consumer (meshPacket_captureStream()).
+#endif
+
+meshPacketStats_t meshPacket_stats;
+bool meshPacket_replayMode = false; //- Set by meshPacket_setReplayMode(). Nothing goes on air, relay delays are skipped.
+
+#define MESH_PACKET_STAT_INC(counter) __atomic_fetch_add(&meshPacket_stats.counter, 1, __ATOMIC_RELAXED) //- Counters are bumped from WiFi task and user task(s).
 
 
 //========================================= FUNCTIONS ==============================================//
@@ -58,9 +83,16 @@ esp_err_t meshPacket_init(uint8_t wifiChannel)
     return ESP_FAIL;
   }
 
+  meshPacket_OutboundQueue = xQueueCreate(MESH_PACKET_OUTBOUND_QUEUE_LENGTH, sizeof(meshPacketOutbound_t));
+  if(meshPacket_OutboundQueue == NULL)
+  {
+    return ESP_FAIL;
+  }
+
   //- NOTE: Register callbacks after queue in case a packet arrives before the queue exists.
-  esp_now_register_send_cb(esp_now_send_cb_t(meshPacket_OnDataSent)); //- Register Send callback to get the status of trasnmitted packet.
-  esp_now_register_recv_cb(esp_now_recv_cb_t(meshPacket_OnDataRecv)); //- Register callback to get received packet info.
+  //- NOTE: No casts. Flow control depends on send callback, signature mismatch with the core must fail to compile.
+  esp_now_register_send_cb(meshPacket_OnDataSent); //- Register Send callback to get the status of trasnmitted packet.
+  esp_now_register_recv_cb(meshPacket_OnDataRecv); //- Register callback to get received packet info.
 
   return meshProtocol_addPeer(meshPacket_broadcastAddress, DEVICE_ID_BROADCAST, wifiChannel); //- Finally let's add broadcast pair.
 }
@@ -223,6 +255,8 @@ void meshPacket_markDelivered(uint16_t uniqueID, uint8_t fromNode)
       Serial.printf("[MESH][INFO]: ACK received from S%02u\n", fromNode);
       #endif
 
+      MESH_PACKET_STAT_INC(acksReceived);
+
       memset(&pending[i], 0, sizeof(PendingAck_t)); //- Clear slot.
       break; //- Stop at first match.
     }
@@ -263,6 +297,230 @@ void meshPacket_addPendingAck(uint16_t uniqueID, uint8_t destID, meshPacket_t *p
   pending[targetIndex].packet = *packet;
 }
 
+void meshPacket_checkAckTimeouts()
+{
+  unsigned long now = millis();
+  for(uint8_t i = 0; i < MESH_PACKET_PENDING_ACKS; i++)
+  {
+    if(pending[i].uniqueID == 0) continue; //- Skip empty slots.
+    if(pending[i].retries & MESH_PACKET_PENDING_LOSS_COUNTED) continue; //- Already counted, slot is kept for retransmission.
+    if(now - pending[i].lastSend <= MESH_PACKET_ACK_TIMEOUT_MS) continue;
+
+    pending[i].retries |= MESH_PACKET_PENDING_LOSS_COUNTED;
+
+    //- Broadcasts are never ACKed by a single node, don't count them as lost.
+    if(pending[i].destID == DEVICE_ID_BROADCAST) continue;
+    MESH_PACKET_STAT_INC(acksLost);
+
+    //- Without a route frame went out on shared broadcast window, one lost ACK must not slow down all floods.
+    int idx = meshPacket_routeFind(pending[i].destID);
+    if(idx >= 0) meshPacket_flowCongestion(routingTable[idx].nextHopMAC);
+
+    #ifdef ENABLE_DEBUG_MESSAGES
+    Serial.printf("[MESH][INFO]: ACK for UID%05u from D%02u lost\n", pending[i].uniqueID, pending[i].destID);
+    #endif
+  }
+}
+
+//- NOTE: Must be called with meshPacket_flowLock held.
+static void meshPacket_flowDecrease(meshPacketFlow_t *flow, uint32_t now)
+{
+  flow->credit = 0;
+  if(now - flow->lastDecrease < MESH_PACKET_FLOW_TIMEOUT_MS) return; //- Losses from the same window count once.
+
+  flow->cwnd = (flow->cwnd / 2 > MESH_PACKET_CWND_MIN) ? flow->cwnd / 2 : MESH_PACKET_CWND_MIN;
+  flow->lastDecrease = now;
+}
+
+//- NOTE: Must be called with meshPacket_flowLock held.
+static int meshPacket_flowFind(const uint8_t *MAC, bool allocate)
+{
+  int freeIndex = -1;
+  int oldestIndex = -1;
+  for(uint8_t i = 0; i < MESH_PACKET_FLOW_HOPS; i++)
+  {
+    if(meshPacket_flow[i].inUse == false)
+    {
+      if(freeIndex < 0) freeIndex = i;
+      continue;
+    }
+    if(memcmp(meshPacket_flow[i].MAC, MAC, 6) == 0) return i;
+
+    //- Idle hops can be recycled when table is full.
+    if(meshPacket_flow[i].inFlight == 0 && (oldestIndex < 0 || meshPacket_flow[i].lastSend < meshPacket_flow[oldestIndex].lastSend)) oldestIndex = i;
+  }
+  if(!allocate) return -1;
+
+  int idx = (freeIndex >= 0) ? freeIndex : oldestIndex;
+  if(idx < 0) return -1; //- Every hop is busy.
+
+  meshPacket_flow[idx].inUse = true;
+  memcpy(meshPacket_flow[idx].MAC, MAC, 6);
+  meshPacket_flow[idx].inFlight = 0;
+  meshPacket_flow[idx].cwnd = MESH_PACKET_CWND_INITIAL;
+  meshPacket_flow[idx].credit = 0;
+  meshPacket_flow[idx].lastSend = millis();
+  meshPacket_flow[idx].lastDecrease = meshPacket_flow[idx].lastSend - MESH_PACKET_FLOW_TIMEOUT_MS;
+  return idx;
+}
+
+bool meshPacket_flowAcquire(const uint8_t *MAC)
+{
+  bool acquired = true;
+  uint32_t now = millis();
+
+  portENTER_CRITICAL(&meshPacket_flowLock);
+  int idx = meshPacket_flowFind(MAC, true);
+  if(idx >= 0) //- NOTE: Hop can't be tracked when table is full of busy hops. Let it through rather than stall.
+  {
+    meshPacketFlow_t *flow = &meshPacket_flow[idx];
+
+    //- Send callback never came. Write frames off and treat it as loss.
+    if(flow->inFlight > 0 && (now - flow->lastSend > MESH_PACKET_FLOW_TIMEOUT_MS))
+    {
+      flow->inFlight = 0;
+      meshPacket_flowDecrease(flow, now);
+    }
+
+    if(flow->inFlight < flow->cwnd)
+    {
+      flow->inFlight++;
+      flow->lastSend = now;
+    }
+    else
+    {
+      acquired = false;
+    }
+  }
+  portEXIT_CRITICAL(&meshPacket_flowLock);
+  return acquired;
+}
+
+void meshPacket_flowRelease(const uint8_t *MAC, bool success)
+{
+  portENTER_CRITICAL(&meshPacket_flowLock);
+  int idx = meshPacket_flowFind(MAC, false);
+  if(idx >= 0)
+  {
+    meshPacketFlow_t *flow = &meshPacket_flow[idx];
+    if(flow->inFlight > 0) flow->inFlight--;
+
+    if(success) //- Additive increase: +1 frame per window worth of successful sends.
+    {
+      if(++flow->credit >= flow->cwnd)
+      {
+        flow->credit = 0;
+        if(flow->cwnd < MESH_PACKET_CWND_MAX) flow->cwnd++;
+      }
+    }
+    else //- Multiplicative decrease.
+    {
+      meshPacket_flowDecrease(flow, millis());
+    }
+  }
+  portEXIT_CRITICAL(&meshPacket_flowLock);
+}
+
+//- Frees window slot of a frame that never went on air. Window size is not changed.
+void meshPacket_flowCancel(const uint8_t *MAC)
+{
+  portENTER_CRITICAL(&meshPacket_flowLock);
+  int idx = meshPacket_flowFind(MAC, false);
+  if(idx >= 0 && meshPacket_flow[idx].inFlight > 0) meshPacket_flow[idx].inFlight--;
+  portEXIT_CRITICAL(&meshPacket_flowLock);
+}
+
+void meshPacket_flowCongestion(const uint8_t *MAC)
+{
+  portENTER_CRITICAL(&meshPacket_flowLock);
+  int idx = meshPacket_flowFind(MAC, false);
+  if(idx >= 0) meshPacket_flowDecrease(&meshPacket_flow[idx], millis());
+  portEXIT_CRITICAL(&meshPacket_flowLock);
+}
+
+//- NOTE: Window slot for MAC must be acquired already.
+static esp_err_t meshPacket_espNowSend(const uint8_t *MAC, const meshPacket_t *localPacket)
+{
+  if(meshPacket_replayMode) //- Replayed traffic must not reach production nodes. No callback will come either.
+  {
+    meshPacket_flowCancel(MAC);
+    MESH_PACKET_STAT_INC(txSuppressed);
+    return ESP_OK;
+  }
+
+  esp_err_t result = esp_now_send(MAC, (const uint8_t *)localPacket, localPacket->payloadLength + MESH_PACKET_HEADER_LENGTH);
+  if(result == ESP_OK)
+  {
+    MESH_PACKET_STAT_INC(txFrames);
+
+    #ifdef MESH_PACKET_ENABLE_CAPTURE
+    meshPacket_captureFrame(MESH_PACKET_CAPTURE_TX, 0, MAC, (const uint8_t *)localPacket, localPacket->payloadLength + MESH_PACKET_HEADER_LENGTH);
+    #endif
+  }
+  else
+  {
+    //- No callback will come. Only a full TX buffer counts as congestion, other errors (e.g. next hop not a peer) leave window as is.
+    if(result == ESP_ERR_ESPNOW_NO_MEM) meshPacket_flowRelease(MAC, false);
+    else meshPacket_flowCancel(MAC);
+    MESH_PACKET_STAT_INC(txErrors);
+  }
+  return result;
+}
+
+//- Hands the frame to ESP-NOW if next hop window allows it, parks it in the outbound queue otherwise.
+esp_err_t meshPacket_transmit(const uint8_t *MAC, const meshPacket_t *localPacket)
+{
+  if(meshPacket_OutboundQueue == NULL) return ESP_ERR_INVALID_STATE; //- meshPacket_init() not called yet.
+
+  //- Older frames go first.
+  if(uxQueueMessagesWaiting(meshPacket_OutboundQueue) > 0) meshPacket_flushOutbound();
+
+  if(meshPacket_flowAcquire(MAC)) return meshPacket_espNowSend(MAC, localPacket);
+
+  meshPacketOutbound_t outbound;
+  memcpy(outbound.MAC, MAC, 6);
+  memcpy(&outbound.packet, localPacket, localPacket->payloadLength + MESH_PACKET_HEADER_LENGTH);
+  if(xQueueSend(meshPacket_OutboundQueue, &outbound, 0) != pdTRUE)
+  {
+    MESH_PACKET_STAT_INC(txBusy);
+
+    #ifdef ENABLE_DEBUG_MESSAGES
+    Serial.printf("[MESH][INFO]: Next hop %02X:%02X:%02X:%02X:%02X:%02X is busy. Packet UID%05u rejected\n", MAC[0], MAC[1], MAC[2], MAC[3], MAC[4], MAC[5], localPacket->uniqueIdentifier);
+    #endif
+    return MESH_PACKET_ERR_BUSY;
+  }
+  MESH_PACKET_STAT_INC(txDeferred);
+  return ESP_OK;
+}
+
+void meshPacket_flushOutbound()
+{
+  if(meshPacket_OutboundQueue == NULL) return;
+
+  uint32_t blockedHops = 0; //- Bitmask of meshPacket_flow[] entries with closed window, keeps per hop order.
+  UBaseType_t count = uxQueueMessagesWaiting(meshPacket_OutboundQueue);
+
+  meshPacketOutbound_t outbound;
+  for(UBaseType_t n = 0; n < count; n++)
+  {
+    if(xQueueReceive(meshPacket_OutboundQueue, &outbound, 0) != pdTRUE) break;
+
+    portENTER_CRITICAL(&meshPacket_flowLock);
+    int idx = meshPacket_flowFind(outbound.MAC, false);
+    portEXIT_CRITICAL(&meshPacket_flowLock);
+
+    bool blocked = (idx >= 0) && (blockedHops & (1UL << idx));
+    if(!blocked && meshPacket_flowAcquire(outbound.MAC))
+    {
+      meshPacket_espNowSend(outbound.MAC, &outbound.packet);
+      continue;
+    }
+
+    if(idx >= 0) blockedHops |= (1UL << idx);
+    if(xQueueSend(meshPacket_OutboundQueue, &outbound, 0) != pdTRUE) MESH_PACKET_STAT_INC(txBusy); //- Back of the line. Fails only if another task took the slot.
+  }
+}
+
 /*
 void checkRetransmissions()
 {
@@ -301,14 +559,170 @@ void checkRetransmissions()
   return esp_now_send(meshPacket_broadcastAddress, (uint8_t*)&beaconPacket, beaconPacket.payloadLength + MESH_PACKET_HEADER_LENGTH); 
 }*/
 
+//- Common part of every relay (unicast, flood, group): spends one hop of TTL and waits a bit. False if TTL is used up.
+static bool meshPacket_relayPrepare(meshPacket_t *localPacket)
+{
+  if(localPacket->TTL == 0) return false; //- Forward only if TTL > 0.
+
+  localPacket->TTL--; //- Decrement TTL before sending. Once per hop, not per branch.
+  if(!meshPacket_replayMode) vTaskDelay(pdMS_TO_TICKS((esp_random() % 5) + 1)); //- Slight delay to avoid saturating network.
+  return true;
+}
+
 void meshPacket_retransmitPacket(meshPacket_t *localPacket, const uint8_t *MAC)
 {
-  if(localPacket->TTL > 0) //- Forward only if TTL > 0.
+  if(meshPacket_relayPrepare(localPacket) && meshPacket_transmit(MAC, localPacket) == ESP_OK) MESH_PACKET_STAT_INC(rxRouted);
+}
+
+esp_err_t meshPacket_subscribe(uint8_t memberID, uint8_t groupID)
+{
+  if(!MESH_PACKET_IS_GROUP(groupID)) return ESP_ERR_INVALID_ARG;
+
+  int idx = -1;
+  for(uint8_t i = 0; i < MESH_PACKET_MAX_SUBSCRIPTIONS; i++)
   {
-    localPacket->TTL--; //- Decrement TTL before sending.
-    vTaskDelay(pdMS_TO_TICKS((esp_random() % 5) + 1)); //- Slight delay to avoid saturating network.
-    esp_now_send(MAC, (uint8_t *)localPacket, localPacket->payloadLength + MESH_PACKET_HEADER_LENGTH);
+    if(groupSubscriptions[i].inUse && groupSubscriptions[i].groupID == groupID && groupSubscriptions[i].memberID == memberID)
+    {
+      idx = i; //- Already subscribed, just advertise again.
+      break;
+    }
+    if(idx < 0 && groupSubscriptions[i].inUse == false) idx = i;
   }
+  if(idx < 0) return ESP_ERR_NO_MEM; //- Return on no available slot.
+
+  groupSubscriptions[idx].inUse = true;
+  groupSubscriptions[idx].groupID = groupID;
+  groupSubscriptions[idx].memberID = memberID;
+
+  #ifdef ENABLE_DEBUG_MESSAGES
+  Serial.printf("[MESH][INFO]: S%02d subscribed to G%03d\n", memberID, groupID);
+  #endif
+
+  return meshPacket_sendMessage(memberID, DEVICE_ID_BROADCAST, PACKET_TYPE_GROUP_JOIN, &groupID, 1);
+}
+
+esp_err_t meshPacket_unsubscribe(uint8_t memberID, uint8_t groupID)
+{
+  for(uint8_t i = 0; i < MESH_PACKET_MAX_SUBSCRIPTIONS; i++)
+  {
+    if(groupSubscriptions[i].inUse && groupSubscriptions[i].groupID == groupID && groupSubscriptions[i].memberID == memberID)
+    {
+      memset(&groupSubscriptions[i], 0, sizeof(groupSubscription_t)); //- Clear slot.
+
+      #ifdef ENABLE_DEBUG_MESSAGES
+      Serial.printf("[MESH][INFO]: S%02d unsubscribed from G%03d\n", memberID, groupID);
+      #endif
+
+      return meshPacket_sendMessage(memberID, DEVICE_ID_BROADCAST, PACKET_TYPE_GROUP_LEAVE, &groupID, 1);
+    }
+  }
+  return ESP_ERR_NOT_FOUND;
+}
+
+bool meshPacket_isSubscribed(uint8_t groupID)
+{
+  for(uint8_t i = 0; i < MESH_PACKET_MAX_SUBSCRIPTIONS; i++)
+  {
+    if(groupSubscriptions[i].inUse && groupSubscriptions[i].groupID == groupID) return 1;
+  }
+  return 0;
+}
+
+esp_err_t meshPacket_groupRouteAdd(uint8_t groupID, uint8_t memberID, const uint8_t *nextHopMAC)
+{
+  int idx = -1;
+  for(uint8_t i = 0; i < MESH_PACKET_MAX_GROUP_ROUTES; i++)
+  {
+    if(groupRoutingTable[i].inUse && groupRoutingTable[i].groupID == groupID && groupRoutingTable[i].memberID == memberID)
+    {
+      idx = i; //- Existing branch. Latest advertisement wins.
+      break;
+    }
+    if(idx < 0 && groupRoutingTable[i].inUse == false) idx = i;
+  }
+  if(idx < 0) return ESP_FAIL; //- Return when no branch is found AND table is full.
+
+  groupRoutingTable[idx].inUse = true;
+  groupRoutingTable[idx].groupID = groupID;
+  groupRoutingTable[idx].memberID = memberID;
+  groupRoutingTable[idx].lastSeen = millis();
+  memcpy(groupRoutingTable[idx].nextHopMAC, nextHopMAC, 6);
+
+  meshProtocol_addPeer(nextHopMAC, memberID, 0); //- Unicast to the branch requires a peer. Fail is expected when peer table is full.
+  return ESP_OK;
+}
+
+void meshPacket_groupRouteRemove(uint8_t groupID, uint8_t memberID)
+{
+  for(uint8_t i = 0; i < MESH_PACKET_MAX_GROUP_ROUTES; i++)
+  {
+    if(groupRoutingTable[i].inUse && groupRoutingTable[i].groupID == groupID && groupRoutingTable[i].memberID == memberID)
+    {
+      groupRoutingTable[i].inUse = false;
+    }
+  }
+}
+
+void meshPacket_groupRouteAge()
+{
+  uint32_t now = millis();
+  for(uint8_t i = 0; i < MESH_PACKET_MAX_GROUP_ROUTES; i++)
+  {
+    if(groupRoutingTable[i].inUse && (now - groupRoutingTable[i].lastSeen > MESH_PACKET_NODE_EXPIRE_TIME_MS))
+    {
+      groupRoutingTable[i].inUse = false; //- Mark as expired.
+
+      #ifdef ENABLE_DEBUG_MESSAGES
+      Serial.printf("[MESH][INFO]: G%03d branch to S%02d expired\n", groupRoutingTable[i].groupID, groupRoutingTable[i].memberID);
+      #endif
+    }
+  }
+}
+
+void meshPacket_groupAdvertise(bool force)
+{
+  uint32_t now = millis();
+  if(!force && (now - meshPacket_lastGroupAdvertise < MESH_PACKET_GROUP_REFRESH_MS)) return;
+  meshPacket_lastGroupAdvertise = now;
+
+  for(uint8_t i = 0; i < MESH_PACKET_MAX_SUBSCRIPTIONS; i++)
+  {
+    if(groupSubscriptions[i].inUse == false) continue;
+    meshPacket_sendMessage(groupSubscriptions[i].memberID, DEVICE_ID_BROADCAST, PACKET_TYPE_GROUP_JOIN, &groupSubscriptions[i].groupID, 1);
+  }
+}
+
+//- Sends one copy per distinct next hop of the group tree. Members behind the same next hop share a copy.
+esp_err_t meshPacket_sendToGroup(const meshPacket_t *localPacket, const uint8_t *excludeMAC)
+{
+  esp_err_t result = ESP_ERR_NOT_FOUND; //- No branches (members) known.
+  for(uint8_t i = 0; i < MESH_PACKET_MAX_GROUP_ROUTES; i++)
+  {
+    if(groupRoutingTable[i].inUse == false || groupRoutingTable[i].groupID != localPacket->destinationID) continue;
+    if(excludeMAC != NULL && memcmp(groupRoutingTable[i].nextHopMAC, excludeMAC, 6) == 0) continue; //- Never send back where it came from.
+
+    //- Skip next hop already served by an earlier branch.
+    bool duplicate = false;
+    for(uint8_t j = 0; j < i; j++)
+    {
+      if(groupRoutingTable[j].inUse && groupRoutingTable[j].groupID == localPacket->destinationID && memcmp(groupRoutingTable[j].nextHopMAC, groupRoutingTable[i].nextHopMAC, 6) == 0)
+      {
+        duplicate = true;
+        break;
+      }
+    }
+    if(duplicate) continue;
+
+    const uint8_t *mac = groupRoutingTable[i].nextHopMAC;
+
+    #ifdef ENABLE_DEBUG_MESSAGES
+    Serial.printf("[MESH][INFO]: G%03d branch / MAC: %02X:%02X:%02X:%02X:%02X:%02X\n", localPacket->destinationID, mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    #endif
+
+    esp_err_t branchResult = meshPacket_transmit(mac, localPacket);
+    if(result == ESP_ERR_NOT_FOUND || (result == ESP_OK && branchResult != ESP_OK)) result = branchResult; //- Report first failure.
+  }
+  return result;
 }
 
 esp_err_t meshPacket_sendMessage(uint8_t sourceID, uint8_t destinationID, uint8_t packetType, const uint8_t *payload, uint8_t payloadLength, bool loopback, int32_t forceUID)
@@ -338,9 +752,17 @@ esp_err_t meshPacket_sendMessage(uint8_t sourceID, uint8_t destinationID, uint8_
   //- Remember mesh packet, so it could be ignored immidiately.
   meshPacket_rememberPacket(sendPacket.sourceID, sendPacket.uniqueIdentifier);
 
-  if(packetType != PACKET_TYPE_ACKNOWLEDGEMENT)
+  //- Group: one copy per tree branch, no ACK (it would come from every member).
+  if(MESH_PACKET_IS_GROUP(destinationID))
   {
-    meshPacket_addPendingAck(sendPacket.uniqueIdentifier, sendPacket.destinationID, &sendPacket);
+    #ifdef ENABLE_DEBUG_MESSAGES
+    Serial.printf("[MESH][INFO]: Sending packet S%02d, G%03d, T%02d, L%02d, UID%05d\n", sourceID, destinationID, packetType, payloadLength, sendPacket.uniqueIdentifier);
+    #endif
+
+    //- Publisher subscribed to its own group gets it too, the same way as loopback. Remembered above, so it won't come back twice.
+    if(meshPacket_isSubscribed(destinationID) && meshPacket_handlePacketCallback != NULL) meshPacket_handlePacketCallback(&sendPacket);
+
+    return meshPacket_sendToGroup(&sendPacket, NULL);
   }
 
   int idx = meshPacket_routeFind(destinationID);
@@ -352,11 +774,23 @@ esp_err_t meshPacket_sendMessage(uint8_t sourceID, uint8_t destinationID, uint8_
   Serial.printf("[MESH][INFO]: First hop D%02d / MAC: %02X:%02X:%02X:%02X:%02X:%02X\n", (idx >= 0) ? routingTable[idx].destinationID : DEVICE_ID_BROADCAST, mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
   #endif
 
-  return esp_now_send(mac, (const uint8_t*)&sendPacket, payloadLength + MESH_PACKET_HEADER_LENGTH);
+  esp_err_t result = meshPacket_transmit(mac, &sendPacket);
+
+  //- Only frames that left (or are queued to leave) are waiting for ACK. Busy frames are up to the caller to resend.
+  if(result == ESP_OK && packetType != PACKET_TYPE_ACKNOWLEDGEMENT && packetType != PACKET_TYPE_GROUP_JOIN && packetType != PACKET_TYPE_GROUP_LEAVE)
+  {
+    meshPacket_addPendingAck(sendPacket.uniqueIdentifier, sendPacket.destinationID, &sendPacket);
+  }
+  return result;
 }
 
-void meshPacket_OnDataSent(const uint8_t *mac_addr, esp_now_send_status_t status)
+static void meshPacket_sendStatus(const uint8_t *mac_addr, esp_now_send_status_t status)
 {
+  if(mac_addr == NULL) return;
+
+  meshPacket_flowRelease(mac_addr, status == ESP_NOW_SEND_SUCCESS);
+  if(status != ESP_NOW_SEND_SUCCESS) MESH_PACKET_STAT_INC(txLinkFailures);
+
   /*for(uint8_t i = 0; i < MAX_IOT_DEVICES; i++)
   {
     if(deviceTelemetry[i].device_MACaddr[0] == mac_addr[0] && deviceTelemetry[i].device_MACaddr[1] == mac_addr[1] && deviceTelemetry[i].device_MACaddr[2] == mac_addr[2] && deviceTelemetry[i].device_MACaddr[3] == mac_addr[3] && deviceTelemetry[i].device_MACaddr[4] == mac_addr[4] && deviceTelemetry[i].device_MACaddr[5] == mac_addr[5])
@@ -369,12 +803,29 @@ void meshPacket_OnDataSent(const uint8_t *mac_addr, esp_now_send_status_t status
   }*/
 }
 
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 5, 0)
+void meshPacket_OnDataSent(const esp_now_send_info_t *tx_info, esp_now_send_status_t status)
+{
+  if(tx_info == NULL) return;
+  meshPacket_sendStatus(tx_info->des_addr, status);
+}
+#else
+void meshPacket_OnDataSent(const uint8_t *mac_addr, esp_now_send_status_t status)
+{
+  meshPacket_sendStatus(mac_addr, status);
+}
+#endif
+
 void meshPacket_OnDataRecv(const esp_now_recv_info_t *esp_now_info, const uint8_t *incomingData, int len)
 {
   if(incomingData == NULL || len <= 0) return; //- Validate arguments. It's probably optional but I don't want to risk it :)
   if(len > sizeof(meshPacket_t)) return;
   if(len < MESH_PACKET_HEADER_LENGTH) return;
 
+  #ifdef MESH_PACKET_ENABLE_CAPTURE
+  meshPacket_captureFrame(MESH_PACKET_CAPTURE_RX, esp_now_info->rx_ctrl->rssi, esp_now_info->src_addr, incomingData, len); //- Before queue, so dropped frames are captured too.
+  #endif
+
   meshPacketQueue_t tmpPacket;
   memset(&tmpPacket, 0, sizeof(tmpPacket)); //- Sanitize data.
   tmpPacket.RSSI = esp_now_info->rx_ctrl->rssi;
@@ -383,9 +834,11 @@ void meshPacket_OnDataRecv(const esp_now_recv_info_t *esp_now_info, const uint8_
   
   if(xQueueSend(meshPacket_Queue, &tmpPacket, 0) != pdTRUE) //- Push to queue.
   {
-    //- ToDo: Implemented error flag, statistics.
+    MESH_PACKET_STAT_INC(rxQueueDrops);
     Serial.printf("[MESH][ERROR]: Queue is FULL. Packet dropped!\n");
+    return;
   }
+  MESH_PACKET_STAT_INC(rxFrames);
 }
 
 void meshPacket_processPackets(uint8_t *acceptedDeviceIDs, uint8_t acceptedDeviceCount, uint32_t waitTime_ms)
@@ -394,6 +847,12 @@ void meshPacket_processPackets(uint8_t *acceptedDeviceIDs, uint8_t acceptedDevic
 
   //- Update routing table, drop stale routings entries.
   meshPacket_routeAge();
+  meshPacket_groupRouteAge();
+  meshPacket_groupAdvertise(false);
+
+  //- Feed ACK loss to flow control, then send what the congestion windows allow.
+  meshPacket_checkAckTimeouts();
+  meshPacket_flushOutbound();
 
   meshPacketQueue_t localQueuePacket;
   while(xQueueReceive(meshPacket_Queue, &localQueuePacket, pdMS_TO_TICKS(waitTime_ms)) == pdTRUE) //- waitTime_ms to prevent xQueueReceive() hammering in a tight spins (no delay, no blocking).
@@ -401,7 +860,11 @@ void meshPacket_processPackets(uint8_t *acceptedDeviceIDs, uint8_t acceptedDevic
     meshPacket_t *localPacket = &localQueuePacket.queuePacket;
 
     //- Drop mesh packet if already seen.
-    if(meshPacket_isPacketSeen(localPacket->sourceID, localPacket->uniqueIdentifier)) continue;
+    if(meshPacket_isPacketSeen(localPacket->sourceID, localPacket->uniqueIdentifier))
+    {
+      MESH_PACKET_STAT_INC(rxDuplicates);
+      continue;
+    }
 
     //- Remember mesh packet.
     meshPacket_rememberPacket(localPacket->sourceID, localPacket->uniqueIdentifier);
@@ -410,6 +873,49 @@ void meshPacket_processPackets(uint8_t *acceptedDeviceIDs, uint8_t acceptedDevic
     Serial.printf("[MESH][INFO]: Packet received S%02d, D%02d, T%02d, Len%02d, UID%05d, RSSI: %ddBm\n", localPacket->sourceID, localPacket->destinationID, localPacket->packetType, localPacket->payloadLength, localPacket->uniqueIdentifier, localQueuePacket.RSSI);
     #endif
 
+    //- Learn reverse route: "to reach S, forward via MAC"
+    int index = meshPacket_routeFind(localPacket->sourceID);
+    if(index >= 0) 
+    {
+      routingTable[index].lastSeen = millis(); //- Update timestamp.
+      routingTable[index].lastRSSI = localQueuePacket.RSSI; //- Update RSSI.
+    }
+    else
+    {
+      meshPacket_routeAdd(localPacket->sourceID, localQueuePacket.MAC, localQueuePacket.RSSI);
+
+      #ifdef ENABLE_DEBUG_MESSAGES
+      Serial.printf("[MESH][INFO]: New route to D%02d\n", localPacket->sourceID);
+      #endif
+    }
+
+    //- Group membership: "to reach member S of group G, forward via MAC". Flood further, hop by hop.
+    if(localPacket->packetType == PACKET_TYPE_GROUP_JOIN || localPacket->packetType == PACKET_TYPE_GROUP_LEAVE)
+    {
+      if(localPacket->payloadLength >= 1 && MESH_PACKET_IS_GROUP((uint8_t)localPacket->payload[0]))
+      {
+        if(localPacket->packetType == PACKET_TYPE_GROUP_JOIN) meshPacket_groupRouteAdd(localPacket->payload[0], localPacket->sourceID, localQueuePacket.MAC);
+        else meshPacket_groupRouteRemove(localPacket->payload[0], localPacket->sourceID);
+
+        meshPacket_retransmitPacket(localPacket, meshPacket_broadcastAddress);
+      }
+      continue;
+    }
+
+    //- Group packet: deliver to local subscribers, then duplicate only where the tree branches.
+    if(MESH_PACKET_IS_GROUP(localPacket->destinationID))
+    {
+      if(meshPacket_isSubscribed(localPacket->destinationID))
+      {
+        MESH_PACKET_STAT_INC(rxDelivered);
+        if(meshPacket_handlePacketCallback != NULL) meshPacket_handlePacketCallback(localPacket);
+      }
+
+      //- Copies arriving over other branches were already dropped by meshPacket_isPacketSeen().
+      if(meshPacket_relayPrepare(localPacket) && meshPacket_sendToGroup(localPacket, localQueuePacket.MAC) == ESP_OK) MESH_PACKET_STAT_INC(rxRouted);
+      continue;
+    }
+
     //- Accept if destinationID matches any in acceptedDeviceIDs OR is broadcast (0xFF).
     volatile bool meshPacket_packetProcessed = false;
     for(uint8_t i = 0; i < acceptedDeviceCount; i++)
@@ -433,22 +939,8 @@ void meshPacket_processPackets(uint8_t *acceptedDeviceIDs, uint8_t acceptedDevic
       }
     }
     
-    //- Learn reverse route: "to reach S, forward via MAC"
-    int index = meshPacket_routeFind(localPacket->sourceID);
-    if(index >= 0) 
-    {
-      routingTable[index].lastSeen = millis(); //- Update timestamp.
-      routingTable[index].lastRSSI = localQueuePacket.RSSI; //- Update RSSI.
-    }
-    else
-    {
-      meshPacket_routeAdd(localPacket->sourceID, localQueuePacket.MAC, localQueuePacket.RSSI);
+    if(meshPacket_packetProcessed) MESH_PACKET_STAT_INC(rxDelivered); //- Once per frame, not per matching accepted ID.
 
-      #ifdef ENABLE_DEBUG_MESSAGES
-      Serial.printf("[MESH][INFO]: New route to D%02d\n", localPacket->sourceID);
-      #endif
-    }
-    
     //- Packet wasn't meant for me, let's route it.
     if(!meshPacket_packetProcessed)
     { 
@@ -481,6 +973,81 @@ void meshPacket_processPackets(uint8_t *acceptedDeviceIDs, uint8_t acceptedDevic
   //checkRetransmissions(); //- ToDo: Move to a better place?
 }
 
+#ifdef MESH_PACKET_ENABLE_CAPTURE
+void meshPacket_captureFrame(uint8_t direction, int8_t RSSI, const uint8_t *MAC, const uint8_t *data, uint8_t length)
+{
+  if(length > sizeof(meshPacket_t)) return;
+
+  //- Claim a ticket. Lock-free, as it is called from WiFi task and sending task(s) at the same time.
+  uint32_t ticket = __atomic_load_n(&meshPacket_captureHead, __ATOMIC_RELAXED);
+  do
+  {
+    if(ticket - __atomic_load_n(&meshPacket_captureTail, __ATOMIC_ACQUIRE) >= MESH_PACKET_CAPTURE_SLOTS) //- Ring is full, consumer is behind.
+    {
+      MESH_PACKET_STAT_INC(captureDrops);
+      return;
+    }
+  } while(!__atomic_compare_exchange_n(&meshPacket_captureHead, &ticket, ticket + 1, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+  meshPacketCaptureSlot_t *slot = &meshPacket_captureRing[ticket & (MESH_PACKET_CAPTURE_SLOTS - 1)];
+  slot->record.timestamp_us = esp_timer_get_time();
+  slot->record.length = length;
+  slot->record.direction = direction;
+  slot->record.RSSI = RSSI;
+  memcpy(slot->record.MAC, MAC, 6);
+  memcpy(&slot->record.frame, data, length);
+
+  __atomic_store_n(&slot->sequence, ticket + 1, __ATOMIC_RELEASE); //- Publish.
+}
+
+size_t meshPacket_captureWriteHeader(Print &out)
+{
+  //- pcap global header, native byte order (readers detect it from magic number).
+  struct __attribute__((packed))
+  {
+    uint32_t magic;
+    uint16_t versionMajor;
+    uint16_t versionMinor;
+    int32_t thisZone;
+    uint32_t sigFigs;
+    uint32_t snapLength;
+    uint32_t linkType;
+  } header = {0xA1B2C3D4, 2, 4, 0, 0, MESH_PACKET_CAPTURE_HEADER_LENGTH + sizeof(meshPacket_t), MESH_PACKET_CAPTURE_LINKTYPE};
+
+  return out.write((const uint8_t *)&header, sizeof(header));
+}
+
+uint32_t meshPacket_captureStream(Print &out, uint32_t maxFrames)
+{
+  uint32_t written = 0;
+  while(written < maxFrames)
+  {
+    uint32_t ticket = __atomic_load_n(&meshPacket_captureTail, __ATOMIC_RELAXED); //- Single consumer.
+    meshPacketCaptureSlot_t *slot = &meshPacket_captureRing[ticket & (MESH_PACKET_CAPTURE_SLOTS - 1)];
+    if(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != ticket + 1) break; //- Empty, or producer is still writing.
+
+    struct __attribute__((packed))
+    {
+      uint32_t seconds;
+      uint32_t microseconds;
+      uint32_t capturedLength;
+      uint32_t originalLength;
+    } recordHeader;
+    recordHeader.seconds = (uint32_t)(slot->record.timestamp_us / 1000000);
+    recordHeader.microseconds = (uint32_t)(slot->record.timestamp_us % 1000000);
+    recordHeader.capturedLength = MESH_PACKET_CAPTURE_HEADER_LENGTH + slot->record.length;
+    recordHeader.originalLength = recordHeader.capturedLength;
+
+    out.write((const uint8_t *)&recordHeader, sizeof(recordHeader));
+    out.write((const uint8_t *)&slot->record.direction, recordHeader.capturedLength); //- Pseudo-header + frame.
+
+    __atomic_store_n(&meshPacket_captureTail, ticket + 1, __ATOMIC_RELEASE); //- Hand slot back to producers.
+    written++;
+  }
+  return written;
+}
+#endif
+
 //====================================== HELPER FUNCTIONS =============================================//
 void meshPacket_printRoutingTable() 
 {
@@ -504,3 +1071,56 @@ void meshPacket_printRoutingTable()
   }
   Serial.println("===================================================================\n");
 }
+
+void meshPacket_getStats(meshPacketStats_t *stats)
+{
+  if(stats == NULL) return;
+  stats->rxFrames     = __atomic_load_n(&meshPacket_stats.rxFrames, __ATOMIC_RELAXED);
+  stats->rxQueueDrops = __atomic_load_n(&meshPacket_stats.rxQueueDrops, __ATOMIC_RELAXED);
+  stats->rxDuplicates = __atomic_load_n(&meshPacket_stats.rxDuplicates, __ATOMIC_RELAXED);
+  stats->rxDelivered  = __atomic_load_n(&meshPacket_stats.rxDelivered, __ATOMIC_RELAXED);
+  stats->rxRouted     = __atomic_load_n(&meshPacket_stats.rxRouted, __ATOMIC_RELAXED);
+  stats->acksReceived = __atomic_load_n(&meshPacket_stats.acksReceived, __ATOMIC_RELAXED);
+  stats->txFrames     = __atomic_load_n(&meshPacket_stats.txFrames, __ATOMIC_RELAXED);
+  stats->txErrors     = __atomic_load_n(&meshPacket_stats.txErrors, __ATOMIC_RELAXED);
+  stats->txLinkFailures = __atomic_load_n(&meshPacket_stats.txLinkFailures, __ATOMIC_RELAXED);
+  stats->txDeferred   = __atomic_load_n(&meshPacket_stats.txDeferred, __ATOMIC_RELAXED);
+  stats->txBusy       = __atomic_load_n(&meshPacket_stats.txBusy, __ATOMIC_RELAXED);
+  stats->txSuppressed = __atomic_load_n(&meshPacket_stats.txSuppressed, __ATOMIC_RELAXED);
+  stats->acksLost     = __atomic_load_n(&meshPacket_stats.acksLost, __ATOMIC_RELAXED);
+  stats->captureDrops = __atomic_load_n(&meshPacket_stats.captureDrops, __ATOMIC_RELAXED);
+}
+
+void meshPacket_resetStats()
+{
+  memset(&meshPacket_stats, 0, sizeof(meshPacket_stats)); //- NOTE: Not atomic as a whole. Counters bumped in between may be lost.
+}
+
+//- Replay mode: frames are counted in txSuppressed instead of being sent, 1-5 ms relay delay is skipped. For examples/meshReplay.
+void meshPacket_setReplayMode(bool enable)
+{
+  meshPacket_replayMode = enable;
+}
+
+void meshPacket_printGroupTable()
+{
+  Serial.println("\n==================== Group Routing Table ====================");
+  Serial.println("Idx | Group | Member |    MAC Address    | LastSeen(ms)| Sub |");
+  Serial.println("----|-------|--------|-------------------|-------------|-----|");
+
+  for(uint8_t i = 0; i < MESH_PACKET_MAX_GROUP_ROUTES; i++)
+  {
+    if(groupRoutingTable[i].inUse)
+    {
+      Serial.printf("%3d | %5d | %6d | %02X:%02X:%02X:%02X:%02X:%02X | %11lu | %-3s |\n",
+        i,
+        groupRoutingTable[i].groupID,
+        groupRoutingTable[i].memberID,
+        groupRoutingTable[i].nextHopMAC[0], groupRoutingTable[i].nextHopMAC[1], groupRoutingTable[i].nextHopMAC[2],
+        groupRoutingTable[i].nextHopMAC[3], groupRoutingTable[i].nextHopMAC[4], groupRoutingTable[i].nextHopMAC[5],
+        millis() - groupRoutingTable[i].lastSeen,
+        meshPacket_isSubscribed(groupRoutingTable[i].groupID) ? "Yes" : "No");
+    }
+  }
+  Serial.println("=============================================================\n");
+}
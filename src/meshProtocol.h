@@ -15,7 +15,6 @@
   3. Peržiūrėti resursus, kuriuos dalinasi task'ai ir sudėti semhaphoras.
   5. Pabaigti implementaciją → checkRetransmissions().
   6. Pabaigti implementaciją → meshPacket_sendBeacon.
-  8. Pridėti benchmark statistikas.
   10. Ištrinti CUSTOM DEVICES ir juos sekti kažkur atskirai. Gal per root node'ą? 
   11. Padaryti konfiguruojamas meshPacket_OnDataRecv, meshPacket_OnDataSent funkcijas naudotojo, kad praplėsti mesh'o panaudojimą už ESP-NOW.
   12. Įdėti thread palaikymą. Paleisti atskirą thread'ą _init metu? 
@@ -30,10 +29,12 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 #include <esp_now.h>
+#include "esp_idf_version.h"
 
 
 //========================================= DEFINES ==============================================//
 #define ENABLE_DEBUG_MESSAGES                    //- Great for debugging, comment for production code.
+//#define MESH_PACKET_ENABLE_CAPTURE             //- Record RX/TX frames for meshPacket_captureStream() (pcap). Uncomment to troubleshoot.
 
 #define MAX_PEERS                         20     //- Limited by ESP-NOW.
 #define MAXIMUM_PACKET_LENGTH	          250    //- Limited by ESP-NOW maximum packet size.
@@ -45,6 +46,27 @@
 #define MESH_PACKET_QUEUE_LENGTH          36     //- Queue length to store meshPackets.
 #define MESH_PACKET_PENDING_ACKS          20     //- Maximum number of ACKs a device can hold at the same time. Maximum is 255.
 #define MESH_PACKET_NODE_EXPIRE_TIME_MS   900000 //- Timeout value for route
+#define MESH_PACKET_ACK_TIMEOUT_MS        500    //- Pending ACK older than this is counted as lost (congestion signal).
+#define MESH_PACKET_PENDING_LOSS_COUNTED  0x80   //- Flag in PendingAck_t.retries: ACK timeout already counted, slot stays until ACKed or replaced.
+
+#define MESH_PACKET_FLOW_HOPS             20     //- Number of next hops tracked by flow control. Maximum is 32.
+#define MESH_PACKET_CWND_MIN              1      //- Congestion window (frames in flight per next hop) lower bound.
+#define MESH_PACKET_CWND_INITIAL          2      //- Congestion window of a newly seen next hop.
+#define MESH_PACKET_CWND_MAX              8      //- Congestion window upper bound. Maximum is 255.
+#define MESH_PACKET_FLOW_TIMEOUT_MS       100    //- In-flight frames without send callback for this long are written off.
+#define MESH_PACKET_OUTBOUND_QUEUE_LENGTH 16     //- Frames waiting for the congestion window to open.
+
+#define MESH_PACKET_ERR_BUSY              0x10001 //- esp_err_t: next hop window is closed AND outbound queue is full. Above all ESP-IDF component bases.
+
+#define MESH_PACKET_MAX_GROUP_ROUTES      30     //- Maximum number of (group, member) branches a device can hold. Maximum is 255.
+#define MESH_PACKET_MAX_SUBSCRIPTIONS     8      //- Maximum number of groups local device(s) can subscribe to. Maximum is 255.
+#define MESH_PACKET_GROUP_REFRESH_MS      300000 //- Subscriptions are re-advertised this often to keep group routes from aging out.
+
+#define MESH_PACKET_CAPTURE_SLOTS         32     //- Capture ring size in frames. Must be a power of two.
+#define MESH_PACKET_CAPTURE_LINKTYPE      147    //- pcap LINKTYPE_USER0. See extras/wireshark/meshProtocol.lua.
+#define MESH_PACKET_CAPTURE_HEADER_LENGTH 8      //- Pseudo-header (direction, RSSI, MAC) in front of each captured frame.
+#define MESH_PACKET_CAPTURE_RX            0
+#define MESH_PACKET_CAPTURE_TX            1
 
 #define MAX_IOT_DEVICES                   128    //- Maximum is 255.
 
@@ -64,12 +86,22 @@
 #define DEVICE_ID_UNCONFIGURED            255	//- NOTE: Can also be used for beacon devices.
 
 
+//----------------- GROUPS (MULTICAST) -----------------//
+#define DEVICE_ID_GROUP_FIRST             200   //- Destination IDs in [FIRST; LAST] range are groups, see meshPacket_subscribe().
+#define DEVICE_ID_GROUP_LAST              239
+#define DEVICE_ID_GROUP_TELEMETRY         200   //- Database + internet gateway.
+
+#define MESH_PACKET_IS_GROUP(id)          ((id) >= DEVICE_ID_GROUP_FIRST && (id) <= DEVICE_ID_GROUP_LAST)
+
+
 //----------------- PACKET TYPES -----------------//
 #define PACKET_TYPE_TELEMETRY             0
 #define PACKET_TYPE_CONTROL               1
 #define PACKET_TYPE_NOTIFICATION          2
 #define PACKET_TYPE_ACKNOWLEDGEMENT       100
 #define PACKET_TYPE_BEACON                101
+#define PACKET_TYPE_GROUP_JOIN            102   //- Payload: group ID. Flooded hop by hop, handled by library.
+#define PACKET_TYPE_GROUP_LEAVE           103   //- Payload: group ID. Flooded hop by hop, handled by library.
 
 
 //====================================== STRUCTURE VARIABLES =============================================//
@@ -117,6 +149,22 @@ struct __attribute__((packed)) routingTable_t
 
 };
 
+struct __attribute__((packed)) groupRoutingTable_t
+{
+    bool inUse;                 //- Marks the slot as used/unused.
+    uint8_t groupID;            //- Group the member subscribed to.
+    uint8_t memberID;           //- Subscribed node.
+    uint8_t nextHopMAC[6];      //- MAC of the next hop towards the member (tree branch).
+    uint32_t lastSeen;          //- millis() timestamp for aging.
+};
+
+struct __attribute__((packed)) groupSubscription_t
+{
+  bool inUse;
+  uint8_t groupID;
+  uint8_t memberID;             //- Local device ID advertised as a member.
+};
+
 struct __attribute__((packed)) PendingAck_t
 {
   uint16_t uniqueID;
@@ -126,6 +174,51 @@ struct __attribute__((packed)) PendingAck_t
   meshPacket_t packet;
 };
 
+struct __attribute__((packed)) meshPacketOutbound_t
+{
+  uint8_t MAC[6];
+  meshPacket_t packet;
+};
+
+struct meshPacketFlow_t
+{
+  bool inUse;
+  uint8_t MAC[6];             //- Next hop MAC.
+  uint8_t inFlight;           //- Frames handed to esp_now_send() without send callback yet.
+  uint8_t cwnd;               //- Congestion window. Additive increase on success, multiplicative decrease on loss.
+  uint8_t credit;             //- Successful sends since last window increase.
+  uint32_t lastSend;          //- millis() timestamp of last frame sent.
+  uint32_t lastDecrease;      //- millis() timestamp of last window decrease. One decrease per MESH_PACKET_FLOW_TIMEOUT_MS.
+};
+
+struct __attribute__((packed)) meshPacketCapture_t
+{
+  uint64_t timestamp_us;        //- esp_timer_get_time() when frame was received / sent.
+  uint8_t length;               //- meshPacket_t bytes actually on air.
+  uint8_t direction;            //- MESH_PACKET_CAPTURE_RX / MESH_PACKET_CAPTURE_TX. From here on the layout is what pcap record holds.
+  int8_t RSSI;                  //- 0 for TX.
+  uint8_t MAC[6];               //- Source MAC for RX, next hop MAC for TX.
+  meshPacket_t frame;
+};
+
+struct meshPacketStats_t
+{
+  uint32_t rxFrames;            //- Frames accepted by meshPacket_OnDataRecv().
+  uint32_t rxQueueDrops;        //- Frames dropped because meshPacket_Queue was full.
+  uint32_t rxDuplicates;        //- Frames dropped by meshPacket_isPacketSeen().
+  uint32_t rxDelivered;         //- Frames handed to local device(s).
+  uint32_t rxRouted;            //- Frames forwarded to the next hop(s): TTL left and transmit returned ESP_OK (sent or queued).
+  uint32_t acksReceived;        //- Pending ACKs cleared by meshPacket_markDelivered().
+  uint32_t txFrames;            //- Frames accepted by esp_now_send().
+  uint32_t txErrors;            //- Frames rejected by esp_now_send().
+  uint32_t txLinkFailures;      //- Frames reported as failed by meshPacket_OnDataSent().
+  uint32_t txDeferred;          //- Frames parked in outbound queue because congestion window was closed.
+  uint32_t txBusy;              //- Frames rejected with MESH_PACKET_ERR_BUSY.
+  uint32_t txSuppressed;        //- Frames not sent because replay mode is on (meshPacket_setReplayMode()).
+  uint32_t acksLost;            //- Pending ACKs expired after MESH_PACKET_ACK_TIMEOUT_MS.
+  uint32_t captureDrops;        //- Frames not captured because capture ring was full.
+};
+
 
 //========================================= FUNCTION PROTOTYPES ==============================================//
 esp_err_t meshPacket_init(uint8_t wifiChannel);
@@ -139,20 +232,55 @@ bool meshPacket_isPacketSeen(uint8_t sourceID, uint16_t uniqueIdentifier);
 uint8_t meshPacket_getActiveDeviceCount(uint32_t lastSeenDeviceThreshold_ms);
 void meshPacket_markDelivered(uint16_t uniqueID, uint8_t fromNode);
 void meshPacket_addPendingAck(uint16_t uniqueID, uint8_t destID, meshPacket_t *packet);
+void meshPacket_checkAckTimeouts();
+bool meshPacket_flowAcquire(const uint8_t *MAC);
+void meshPacket_flowRelease(const uint8_t *MAC, bool success);
+void meshPacket_flowCancel(const uint8_t *MAC);
+void meshPacket_flowCongestion(const uint8_t *MAC);
+esp_err_t meshPacket_transmit(const uint8_t *MAC, const meshPacket_t *localPacket);
+void meshPacket_flushOutbound();
 void meshPacket_retransmitPacket(meshPacket_t *localPacket, const uint8_t *MAC);
+esp_err_t meshPacket_subscribe(uint8_t memberID, uint8_t groupID);
+esp_err_t meshPacket_unsubscribe(uint8_t memberID, uint8_t groupID);
+bool meshPacket_isSubscribed(uint8_t groupID);
+esp_err_t meshPacket_groupRouteAdd(uint8_t groupID, uint8_t memberID, const uint8_t *nextHopMAC);
+void meshPacket_groupRouteRemove(uint8_t groupID, uint8_t memberID);
+void meshPacket_groupRouteAge();
+void meshPacket_groupAdvertise(bool force);
+esp_err_t meshPacket_sendToGroup(const meshPacket_t *localPacket, const uint8_t *excludeMAC);
 esp_err_t meshPacket_sendMessage(uint8_t sourceID, uint8_t destinationID, uint8_t packetType, const uint8_t *payload, uint8_t payloadLength, bool loopback = false, int32_t forceUID = -1);
 void meshPacket_processPackets(uint8_t *acceptedDeviceIDs, uint8_t acceptedDeviceCount, uint32_t waitTime_ms);
+#ifdef MESH_PACKET_ENABLE_CAPTURE
+class Print; //- Arduino Print (Serial, File, WiFiClient, ...).
+void meshPacket_captureFrame(uint8_t direction, int8_t RSSI, const uint8_t *MAC, const uint8_t *data, uint8_t length);
+size_t meshPacket_captureWriteHeader(Print &out);
+uint32_t meshPacket_captureStream(Print &out, uint32_t maxFrames);
+#endif
 void meshPacket_printRoutingTable();
+void meshPacket_printGroupTable();
+void meshPacket_getStats(meshPacketStats_t *stats);
+void meshPacket_resetStats();
+void meshPacket_setReplayMode(bool enable);
 
 void meshPacket_handlePacketCallback(meshPacket_t *localPacket) __attribute__((weak));
 void meshPacket_OnDataRecv(const esp_now_recv_info_t *esp_now_info, const uint8_t *incomingData, int len);
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 5, 0) //- Arduino-ESP32 >= 3.3.0 passes send info instead of MAC.
+void meshPacket_OnDataSent(const esp_now_send_info_t *tx_info, esp_now_send_status_t status);
+#else
 void meshPacket_OnDataSent(const uint8_t *mac_addr, esp_now_send_status_t status);
+#endif
 
 
 
 
 //========================================= VALIDATION CHECKS ==============================================//
 static_assert(MESH_PACKET_HEADER_LENGTH == offsetof(meshPacket_t, payload), "ERROR: meshPacket_t header length mismatch!");
+static_assert(DEVICE_ID_GROUP_FIRST >= MAX_IOT_DEVICES && DEVICE_ID_GROUP_LAST < DEVICE_ID_DATABASE, "ERROR: Group IDs overlap device IDs!");
+static_assert(MESH_PACKET_GROUP_REFRESH_MS < MESH_PACKET_NODE_EXPIRE_TIME_MS, "ERROR: Group routes would expire before being refreshed!");
+static_assert((MESH_PACKET_CAPTURE_SLOTS & (MESH_PACKET_CAPTURE_SLOTS - 1)) == 0, "ERROR: MESH_PACKET_CAPTURE_SLOTS must be a power of two!");
+static_assert(offsetof(meshPacketCapture_t, frame) - offsetof(meshPacketCapture_t, direction) == MESH_PACKET_CAPTURE_HEADER_LENGTH, "ERROR: meshPacketCapture_t pseudo-header length mismatch!");
+static_assert(MESH_PACKET_FLOW_HOPS <= 32, "ERROR: MESH_PACKET_FLOW_HOPS must fit meshPacket_flushOutbound() bitmask!");
+static_assert(MESH_PACKET_CWND_MIN >= 1 && MESH_PACKET_CWND_MIN <= MESH_PACKET_CWND_INITIAL && MESH_PACKET_CWND_INITIAL <= MESH_PACKET_CWND_MAX, "ERROR: Congestion window limits are invalid!");
 
 
 
@@ -223,6 +351,26 @@ static_assert(MESH_PACKET_HEADER_LENGTH == offsetof(meshPacket_t, payload), "ERR
                     --- v1.6 ---
 	  1. CHORE: library migrated from .ino file to proper library folder (.h, .cpp). No functional changes.
 	  2. 
+
+	             --- 2026-10-19  ---
+                    --- v1.7 ---
+	  1. FEATURE: Packet counters (meshPacketStats_t) added. Read with meshPacket_getStats(), clear with meshPacket_resetStats().
+	     rxDelivered is counted once per frame, rxRouted only when a relayed frame was actually handed over (TTL left, ESP_OK).
+	  2. FEATURE: examples/meshBenchmark sketch added to measure per-packet CPU cost of the hot path (JSON output + regression thresholds).
+	  3. FEATURE: Per next hop flow control. Frames in flight are tracked through meshPacket_OnDataSent() against an AIMD congestion window
+	     (halved on full TX buffer / send failure callback / ACK timeout of a routed frame). Frames over the window wait in a bounded outbound queue,
+	     MESH_PACKET_ERR_BUSY is returned when it is full. Sending before meshPacket_init() returns ESP_ERR_INVALID_STATE.
+	     Callbacks are registered without casts, meshPacket_OnDataSent() follows core signature (esp_now_send_info_t from ESP-IDF 5.5 / Arduino-ESP32 3.3).
+	     ACK timeout only marks pending slot (MESH_PACKET_PENDING_LOSS_COUNTED in retries), slot is still freed by ACK or replaced when table is full.
+	  4. FEATURE: Multicast groups (DEVICE_ID_GROUP_FIRST..LAST). meshPacket_subscribe()/meshPacket_unsubscribe() flood GROUP_JOIN/LEAVE hop by hop,
+	     relays learn one branch per member and duplicate group frames only once per distinct next hop. Group frames are not ACKed.
+	     Every node relays a group frame at most once (first copy wins, later copies are dropped by meshPacket_isPacketSeen()).
+	     Publisher subscribed to its own group gets its frames in meshPacket_handlePacketCallback() like loopback.
+	  5. CHORE: Reverse route is learned before the packet is handed to the callback, so replies from the callback don't fall back to broadcast.
+	  6. FEATURE: Optional frame capture (#define MESH_PACKET_ENABLE_CAPTURE). RX and TX frames with timestamp, RSSI and MAC go to a lock-free ring,
+	     meshPacket_captureStream() writes them out as pcap (LINKTYPE_USER0). Wireshark dissector and replay tool are in extras/, examples/meshReplay.
+	     meshPacket_setReplayMode() keeps replayed frames off air (counted in txSuppressed) and skips the 1-5 ms relay delay, so replay measures processing only.
+	  7. 
 */
 
 